@@ -0,0 +1,246 @@
+/* Author: Nicholas Budny */
+
+/* benchbatch.c - Measures the cost per key of loading a table one key at
+ * a time with SymTable_put and all at once with SymTable_putMany, then of
+ * looking up keys one at a time with SymTable_get, in batches with
+ * SymTable_getMany, and with SymTable_getManyInterleaved at each batch
+ * width, on a table large enough that most lookups miss the last-level
+ * cache. An optional chain length makes the tables hash groups of that
+ * many keys alike, to measure walks of long chains. */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "symtable.h"
+
+/* Default number of bindings: about 300 MB of bindings and buckets,
+ * larger than the last-level cache of most servers */
+enum { DEFAULT_COUNT = 4000000 };
+
+/* Number of keys per call of SymTable_getMany and
+ * SymTable_getManyInterleaved */
+enum { BATCH_SIZE = 512 };
+
+/* Number of times each measurement is repeated; the fastest is kept */
+enum { ROUNDS = 3 };
+
+/* Length of a generated key, including the null terminator */
+enum { KEY_LENGTH = 17 };
+
+/* Returns the current monotonic time in nanoseconds */
+static double nowNs(void) {
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+    return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/* State of the xorshift generator behind nextRandom */
+static unsigned long long ullRandomState = 0x9e3779b97f4a7c15ULL;
+
+/* Returns the next number of a fixed pseudo-random sequence */
+static unsigned long long nextRandom(void) {
+    ullRandomState ^= ullRandomState << 13;
+    ullRandomState ^= ullRandomState >> 7;
+    ullRandomState ^= ullRandomState << 17;
+    return ullRandomState;
+}
+
+/* Number of distinct hashes given out by groupHash */
+static size_t uHashGroups;
+
+/* A hash function that hashes every key to one of uHashGroups values,
+ * so that the bindings of a table share that many hash chains */
+static size_t groupHash(const char *pcKey, size_t uKeyLength,
+                        const void *pvHashExtra) {
+    return SymTable_hashWyhash(pcKey, uKeyLength, pvHashExtra) % uHashGroups;
+}
+
+/* Returns a new empty table that hashes keys with SymTable_hashWyhash,
+ * or with groupHash if iGrouped, or NULL if insufficient memory is
+ * available */
+static SymTable_T newTable(int iGrouped) {
+    return SymTable_newWithHash(iGrouped ? groupHash : SymTable_hashWyhash,
+                                NULL);
+}
+
+/* Puts the uCount keys apcKeys, bound to themselves, into a new table
+ * hashed as newTable(iGrouped) hashes, one at a time with SymTable_put
+ * or all at once with SymTable_putMany if iMany, ROUNDS times. Stores
+ * the least cost in ns per key in *pdCost.
+ * Returns the table of the last round, or NULL if any key was not added.
+ */
+static SymTable_T load(const char *apcKeys[], size_t uCount, int iGrouped,
+                       int iMany, double *pdCost) {
+    SymTable_T oSymTable = NULL;
+    double dStart;
+    size_t uAdded;
+    size_t uRound;
+    size_t i;
+
+    *pdCost = -1.0;
+    for (uRound = 0; uRound < ROUNDS; uRound++) {
+        if (oSymTable != NULL)
+            SymTable_free(oSymTable);
+        oSymTable = newTable(iGrouped);
+        if (oSymTable == NULL)
+            return NULL;
+
+        uAdded = 0;
+        dStart = nowNs();
+        if (iMany)
+            uAdded = SymTable_putMany(oSymTable, apcKeys,
+                                      (const void **)apcKeys, uCount, NULL);
+        else {
+            for (i = 0; i < uCount; i++)
+                uAdded += (size_t)SymTable_put(oSymTable, apcKeys[i],
+                                               apcKeys[i]);
+        }
+        dStart = (nowNs() - dStart) / (double)uCount;
+
+        if (uAdded != uCount) {
+            SymTable_free(oSymTable);
+            return NULL;
+        }
+        if (*pdCost < 0.0 || dStart < *pdCost)
+            *pdCost = dStart;
+    }
+
+    return oSymTable;
+}
+
+/* Looks up the uCount keys apcKeys in oSymTable, uWidth at a time with
+ * SymTable_getManyInterleaved, or in batches with SymTable_getMany if
+ * uWidth is 0, or one at a time with SymTable_get if uWidth is
+ * (size_t)-1, ROUNDS times.
+ * Returns the least cost in ns per key, or a negative number if any key
+ * was not found.
+ */
+static double measure(SymTable_T oSymTable, const char *apcKeys[],
+                      size_t uCount, size_t uWidth) {
+    static void *apvValues[BATCH_SIZE];
+    double dBest = -1.0;
+    double dStart;
+    size_t uFound;
+    size_t uBatch;
+    size_t uRound;
+    size_t i;
+    size_t j;
+
+    for (uRound = 0; uRound < ROUNDS; uRound++) {
+        uFound = 0;
+        dStart = nowNs();
+        for (i = 0; i < uCount; i += uBatch) {
+            uBatch = uCount - i < BATCH_SIZE ? uCount - i : BATCH_SIZE;
+            if (uWidth == (size_t)-1) {
+                for (j = 0; j < uBatch; j++)
+                    uFound += SymTable_get(oSymTable, apcKeys[i + j]) != NULL;
+            }
+            else if (uWidth == 0)
+                uFound += SymTable_getMany(oSymTable, apcKeys + i, uBatch,
+                                           apvValues);
+            else
+                uFound += SymTable_getManyInterleaved(oSymTable, apcKeys + i,
+                                                      uBatch, apvValues,
+                                                      uWidth);
+        }
+        dStart = (nowNs() - dStart) / (double)uCount;
+
+        if (uFound != uCount)
+            return -1.0;
+        if (dBest < 0.0 || dStart < dBest)
+            dBest = dStart;
+    }
+
+    return dBest;
+}
+
+/* Puts bindingcount (default DEFAULT_COUNT) random keys into a table,
+ * hashed with SymTable_hashWyhash or, given a chain length, into
+ * bindingcount / chainlength chains, by each method, then looks every
+ * key up in random order by each method. Writes the cost per key of each
+ * to stdout.
+ * Returns 0, or EXIT_FAILURE on bad arguments, a key not found, or no
+ * memory.
+ */
+int main(int argc, char *argv[]) {
+    SymTable_T oSymTable;
+    char *pcKeys;
+    const char **apcKeys;
+    const char *pcSwap;
+    long lCount = argc > 1 ? atol(argv[1]) : DEFAULT_COUNT;
+    long lChainLength = argc > 2 ? atol(argv[2]) : 1;
+    size_t uCount;
+    size_t uWidth;
+    size_t i;
+    size_t j;
+    double dCost;
+
+    if (argc > 3 || lCount <= 0 || lChainLength <= 0) {
+        fprintf(stderr, "Usage: %s [bindingcount [chainlength]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    uCount = (size_t)lCount;
+    uHashGroups = (uCount + (size_t)lChainLength - 1) / (size_t)lChainLength;
+
+    pcKeys = malloc(uCount * KEY_LENGTH);
+    apcKeys = malloc(uCount * sizeof(*apcKeys));
+    if (pcKeys == NULL || apcKeys == NULL) {
+        fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < uCount; i++) {
+        sprintf(pcKeys + i * KEY_LENGTH, "%016llx", nextRandom());
+        apcKeys[i] = pcKeys + i * KEY_LENGTH;
+    }
+
+    printf("%s: %lu bindings, chain length %ld, ns per key\n", argv[0],
+           (unsigned long)uCount, lChainLength);
+
+    /* Random keys, so two collide only with negligible probability */
+    oSymTable = load(apcKeys, uCount, lChainLength > 1, 0, &dCost);
+    if (oSymTable != NULL) {
+        printf("%-12s %9.1f\n", "put", dCost);
+        SymTable_free(oSymTable);
+        oSymTable = load(apcKeys, uCount, lChainLength > 1, 1, &dCost);
+        printf("%-12s %9.1f\n", "putMany", dCost);
+    }
+    if (oSymTable == NULL) {
+        fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Look the keys up in an order unrelated to where they are stored */
+    for (i = uCount - 1; i > 0; i--) {
+        j = (size_t)(nextRandom() % (i + 1));
+        pcSwap = apcKeys[i];
+        apcKeys[i] = apcKeys[j];
+        apcKeys[j] = pcSwap;
+    }
+
+    /* Widths (size_t)-1 and 0 stand for get and getMany, and wrap round
+     * to the interleaved widths 1, 2, 4, ... */
+    for (uWidth = (size_t)-1; uWidth == (size_t)-1 ||
+                              uWidth <= SYMTABLE_MAX_INTERLEAVE;
+         uWidth = uWidth + 1 < 2 ? uWidth + 1 : uWidth * 2) {
+        dCost = measure(oSymTable, apcKeys, uCount, uWidth);
+        if (dCost < 0.0) {
+            fprintf(stderr, "%s: a key was not found\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (uWidth == (size_t)-1)
+            printf("%-12s %9.1f\n", "get", dCost);
+        else if (uWidth == 0)
+            printf("%-12s %9.1f\n", "getMany", dCost);
+        else
+            printf("width %-6lu %9.1f\n", (unsigned long)uWidth, dCost);
+    }
+
+    SymTable_free(oSymTable);
+    free(apcKeys);
+    free(pcKeys);
+    return 0;
+}
@@ -0,0 +1,68 @@
+#!/bin/sh
+# Author: Nicholas Budny
+
+# benchcompare.sh - Runs the same benchsymtable workloads against every
+# SymTable implementation and writes one combined table, as CSV or (with
+# -m) as a markdown table.
+#
+# Usage: ./benchcompare.sh [-m] [bindingcount ...]
+#
+# The default counts span tiny tables, where the linked list can win, to
+# large ones. The linked list is skipped above LIST_MAX_COUNT bindings,
+# where each of its runs would take minutes. Run "make" first.
+
+BACKENDS="list hash robin swiss"
+COUNTS="8 32 128 512 4096 65536 1000000"
+LIST_MAX_COUNT=4096
+
+markdown=0
+if [ "$1" = "-m" ]; then
+    markdown=1
+    shift
+fi
+if [ $# -gt 0 ]; then
+    COUNTS="$*"
+fi
+
+for backend in $BACKENDS; do
+    if [ ! -x "./benchsymtable$backend" ]; then
+        echo "$0: ./benchsymtable$backend not found; run make first" >&2
+        exit 1
+    fi
+done
+
+# Prefix each record with the backend, keeping a single header line
+run_all() {
+    echo "backend,distribution,bindings,operation,ns_per_call,mcalls_per_s,p50_ns,p99_ns,bytes_per_binding"
+    for count in $COUNTS; do
+        for backend in $BACKENDS; do
+            if [ "$backend" = list ] && [ "$count" -gt "$LIST_MAX_COUNT" ]; then
+                continue
+            fi
+            "./benchsymtable$backend" -csv "$count" | sed 1d |
+                sed "s/^/$backend,/" || exit 1
+        done
+    done
+}
+
+if [ "$markdown" -eq 0 ]; then
+    run_all
+    exit
+fi
+
+run_all | awk -F, '
+NR == 1 {
+    line = "|"; rule = "|"
+    for (i = 1; i <= NF; i++) {
+        line = line " " $i " |"
+        rule = rule (i <= 4 ? " --- |" : " ---: |")
+    }
+    print line; print rule
+    next
+}
+{
+    line = "|"
+    for (i = 1; i <= NF; i++)
+        line = line " " $i " |"
+    print line
+}'
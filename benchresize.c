@@ -0,0 +1,123 @@
+/* Author: Nicholas Budny */
+
+/* benchresize.c - Measures the latency of individual SymTable_put calls,
+ * to expose the stalls caused by resizing a hash table. Link against the
+ * stop-the-world build (benchresize) or the incremental build
+ * (benchresizeinc) of symtablehash.c to compare them. The *trace builds
+ * also report the histograms recorded by a -DSYMTABLE_TRACE table, which
+ * separate the puts that resized the table from the rest. */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "symtable.h"
+
+/* Maximum length of a generated key, including the null terminator */
+enum { MAX_KEY_LENGTH = 24 };
+
+/* Returns the current monotonic time in nanoseconds */
+static double nowNs(void) {
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+    return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/* Compares two doubles for qsort, in ascending order */
+static int compareDoubles(const void *pvFirst, const void *pvSecond) {
+    double dFirst = *(const double *)pvFirst;
+    double dSecond = *(const double *)pvSecond;
+
+    return (dFirst > dSecond) - (dFirst < dSecond);
+}
+
+/* Writes the count, median, p99 and worst case of the latency histogram
+ * of operation eOp on oSymTable to stdout, under the name pcName.
+ * Writes nothing if oSymTable does not record latencies.
+ */
+static void printHistogram(SymTable_T oSymTable, enum SymTable_Op eOp,
+                           const char *pcName) {
+    unsigned long aulCounts[SYMTABLE_LATENCY_BUCKETS];
+    unsigned long ulTotal = 0;
+    unsigned long ulSeen = 0;
+    unsigned long long ullP50 = 0;
+    unsigned long long ullP99 = 0;
+    unsigned long long ullMax = 0;
+    size_t i;
+
+    if (!SymTable_getLatencyHistogram(oSymTable, eOp, aulCounts))
+        return;
+
+    for (i = 0; i < SYMTABLE_LATENCY_BUCKETS; i++)
+        ulTotal += aulCounts[i];
+
+    /* Report each quantile as the lower bound of the bucket holding it */
+    for (i = 0; i < SYMTABLE_LATENCY_BUCKETS; i++) {
+        if (aulCounts[i] == 0)
+            continue;
+        if (ulSeen <= ulTotal / 2 && ulSeen + aulCounts[i] > ulTotal / 2)
+            ullP50 = SymTable_latencyBucketStart(i);
+        if (ulSeen <= ulTotal * 99 / 100 &&
+            ulSeen + aulCounts[i] > ulTotal * 99 / 100)
+            ullP99 = SymTable_latencyBucketStart(i);
+        ulSeen += aulCounts[i];
+        ullMax = SymTable_latencyBucketStart(i);
+    }
+
+    printf("  %-7s %9lu calls  p50 >= %llu  p99 >= %llu  max >= %llu ticks\n",
+           pcName, ulTotal, ullP50, ullP99, ullMax);
+}
+
+/* Puts argv[1] (default 1000000) bindings into a new SymTable, timing
+ * each put, and writes the mean, p99, p99.9 and worst-case put latency
+ * to stdout, followed by the put and resize histograms of the table if it
+ * records them. Returns 0, or EXIT_FAILURE on bad arguments or no memory.
+ */
+int main(int argc, char *argv[]) {
+    SymTable_T oSymTable;
+    char acKey[MAX_KEY_LENGTH];
+    double *pdLatencies;
+    double dStart;
+    double dTotal = 0.0;
+    long lCount = 1000000;
+    size_t uCount;
+    size_t i;
+
+    if (argc > 2 || (argc == 2 && (sscanf(argv[1], "%ld", &lCount) != 1 ||
+                                   lCount <= 0))) {
+        fprintf(stderr, "Usage: %s [bindingcount]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    uCount = (size_t)lCount;
+
+    pdLatencies = malloc(uCount * sizeof(double));
+    oSymTable = SymTable_new();
+    if (pdLatencies == NULL || oSymTable == NULL) {
+        fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < uCount; i++) {
+        sprintf(acKey, "%lu", (unsigned long)i);
+        dStart = nowNs();
+        SymTable_put(oSymTable, acKey, NULL);
+        pdLatencies[i] = nowNs() - dStart;
+        dTotal += pdLatencies[i];
+    }
+
+    qsort(pdLatencies, uCount, sizeof(double), compareDoubles);
+
+    printf("%s: %lu puts\n", argv[0], (unsigned long)uCount);
+    printf("  mean  %12.0f ns\n", dTotal / (double)uCount);
+    printf("  p99   %12.0f ns\n", pdLatencies[uCount * 99 / 100]);
+    printf("  p99.9 %12.0f ns\n", pdLatencies[uCount * 999 / 1000]);
+    printf("  max   %12.0f ns\n", pdLatencies[uCount - 1]);
+    printHistogram(oSymTable, SYMTABLE_OP_PUT, "put");
+    printHistogram(oSymTable, SYMTABLE_OP_RESIZE, "resize");
+
+    SymTable_free(oSymTable);
+    free(pdLatencies);
+    return 0;
+}
@@ -0,0 +1,915 @@
+/* Author: Nicholas Budny */
+
+/* benchsymtable.c - Measures the cost per call of each SymTable
+ * operation under several key distributions. Links against any SymTable
+ * implementation; the Makefile builds one binary per implementation.
+ * On Linux, can also count hardware events per call with
+ * perf_event_open. */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#else
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "symtable.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* Default number of bindings per workload */
+enum { DEFAULT_COUNT = 1000000 };
+
+/* Minimum number of calls per phase; small workloads are repeated on
+ * fresh tables until they reach it */
+enum { MIN_CALLS = 65536 };
+
+/* Maximum number of bindings in the adversarial workload, whose
+ * operations each walk every binding */
+enum { ADVERSARIAL_MAX_COUNT = 4096 };
+
+/* Number of keys per call of the batch-get phase */
+enum { BATCH_SIZE = 256 };
+
+/* Exponent of the Zipfian distribution; 0.99 is the usual YCSB skew */
+static const double ZIPF_EXPONENT = 0.99;
+
+/* Two blocks of equal length whose hashes under the assignment hash
+ * (multiplier 65599, wrapping at 2^64) are equal, found by lattice
+ * reduction. Every string made of n such blocks has the same hash, so
+ * 2^n keys fall into a single chain or probe sequence.
+ */
+static const char acBlockA[] = "baffaaeaajcaaafc";
+static const char acBlockB[] = "acaagbacbaabccaa";
+
+/* A KeySet holds 2 * uCount distinct keys in one array. Keys below
+ * uCount are the ones put into the table; the rest are used as misses.
+ */
+typedef struct KeySet {
+    /* Key i starts at pcKeys + i * uStride */
+    char *pcKeys;
+    /* Bytes between consecutive keys */
+    size_t uStride;
+    /* Number of keys that are put into the table */
+    size_t uCount;
+} KeySet;
+
+/* A Workload is a key set plus the order in which it is accessed. */
+typedef struct Workload {
+    /* Name printed in the report */
+    const char *pcName;
+    /* Keys to put and to miss */
+    KeySet sKeys;
+    /* uCount key indexes for the hit-get, batch-get and replace phases */
+    size_t *puAccess;
+    /* Permutation of the uCount key indexes for the remove phase */
+    size_t *puRemove;
+} Workload;
+
+/* The measured phases, in the order they run against each table */
+enum Phase {
+    PUT, HIT_GET, BATCH_GET, MISS_GET, REPLACE, MAP, REMOVE, PHASE_COUNT
+};
+
+/* Names of the phases, indexed by enum Phase */
+static const char *const apcPhaseNames[PHASE_COUNT] = {
+    "put", "hit-get", "batch-get", "miss-get", "replace", "map", "remove"
+};
+
+/* Number of events counted per phase with -perf */
+enum { EVENT_COUNT = 7 };
+
+/* Names of the counted events */
+static const char *const apcEventNames[EVENT_COUNT] = {
+    "cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses",
+    "dTLB-misses", "page-faults"
+};
+
+/* A Result holds the measurements of one workload. Costs are in ns per
+ * call, except for map, whose costs are per binding visited, and
+ * batch-get, whose costs are per key looked up.
+ */
+typedef struct Result {
+    /* Mean cost of each phase, timed as a whole */
+    double adMean[PHASE_COUNT];
+    /* Median and 99th percentile cost of single calls of each phase */
+    double adP50[PHASE_COUNT];
+    double adP99[PHASE_COUNT];
+    /* Bytes allocated by the table, per binding, once every key is put */
+    double dBytesPerBinding;
+    /* Mean count of each event per call of each phase, or -1 if the
+     * event could not be counted */
+    double aadEvents[PHASE_COUNT][EVENT_COUNT];
+} Result;
+
+/* Hash function of the tables, or NULL for each implementation's own;
+ * set with -wyhash */
+static size_t (*pfTableHash)(const char *pcKey, size_t uKeyLength,
+                             const void *pvHashExtra) = NULL;
+
+/* Whether the tables are made by SymTable_newSeeded; set with -seeded */
+static int iSeededTables = 0;
+
+/* State of the pseudo-random number generator; fixed so that every run
+ * and every implementation sees the same keys in the same order */
+static unsigned long long ullRandomState = 0x9e3779b97f4a7c15ULL;
+
+/* Returns the next value of a xorshift64* generator */
+static unsigned long long nextRandom(void) {
+    ullRandomState ^= ullRandomState >> 12;
+    ullRandomState ^= ullRandomState << 25;
+    ullRandomState ^= ullRandomState >> 27;
+    return ullRandomState * 0x2545f4914f6cdd1dULL;
+}
+
+/* Returns a pseudo-random index below uBound */
+static size_t randomIndex(size_t uBound) {
+    return (size_t)(nextRandom() % uBound);
+}
+
+/* Returns a pseudo-random double in [0, 1) */
+static double randomUnit(void) {
+    return (double)(nextRandom() >> 11) / 9007199254740992.0;
+}
+
+/* Returns a bijective scramble of ullValue (the MurmurHash3 finalizer),
+ * so distinct inputs give distinct outputs */
+static unsigned long long scramble(unsigned long long ullValue) {
+    ullValue ^= ullValue >> 33;
+    ullValue *= 0xff51afd7ed558ccdULL;
+    ullValue ^= ullValue >> 33;
+    ullValue *= 0xc4ceb9fe1a85ec53ULL;
+    ullValue ^= ullValue >> 33;
+    return ullValue;
+}
+
+/* Compares two floats for qsort, in ascending order */
+static int compareFloats(const void *pvFirst, const void *pvSecond) {
+    float fFirst = *(const float *)pvFirst;
+    float fSecond = *(const float *)pvSecond;
+
+    return (fFirst > fSecond) - (fFirst < fSecond);
+}
+
+/* Returns the current monotonic time in nanoseconds */
+static double nowNs(void) {
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+    return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/* Returns the median cost in ns of reading the clock, which the cost of
+ * a single timed call includes */
+static double clockOverhead(void) {
+    enum { SAMPLE_COUNT = 1001 };
+    float afSamples[SAMPLE_COUNT];
+    double dStart;
+    size_t i;
+
+    for (i = 0; i < SAMPLE_COUNT; i++) {
+        dStart = nowNs();
+        afSamples[i] = (float)(nowNs() - dStart);
+    }
+    qsort(afSamples, SAMPLE_COUNT, sizeof(float), compareFloats);
+    return afSamples[SAMPLE_COUNT / 2];
+}
+
+#ifdef __linux__
+
+/* File descriptor of the open counter of each event, or -1; valid only
+ * once openEvents has been called */
+static int aiEventFds[EVENT_COUNT];
+
+/* 1 once openEvents has been called, 0 before */
+static int iEventsOpened = 0;
+
+/* Opens a counter for each event of apcEventNames that this machine
+ * supports, counting user-space activity of this process only.
+ * Returns the number of counters opened.
+ */
+static int openEvents(void) {
+    static const struct { unsigned uType; unsigned long long ullConfig; }
+    asEvents[EVENT_COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL |
+                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}
+    };
+    struct perf_event_attr sAttr;
+    int iOpened = 0;
+    int iEvent;
+
+    iEventsOpened = 1;
+    for (iEvent = 0; iEvent < EVENT_COUNT; iEvent++) {
+        memset(&sAttr, 0, sizeof(sAttr));
+        sAttr.size = sizeof(sAttr);
+        sAttr.type = asEvents[iEvent].uType;
+        sAttr.config = asEvents[iEvent].ullConfig;
+        sAttr.disabled = 1;
+        sAttr.exclude_kernel = 1;
+        sAttr.exclude_hv = 1;
+        /* The kernel may multiplex more events than there are hardware
+         * counters; the running time lets stopEvents scale for that */
+        sAttr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                            PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        aiEventFds[iEvent] = (int)syscall(SYS_perf_event_open, &sAttr, 0, -1,
+                                          -1, 0);
+        if (aiEventFds[iEvent] >= 0)
+            iOpened++;
+    }
+
+    return iOpened;
+}
+
+/* Resets and starts every open counter */
+static void startEvents(void) {
+    int iEvent;
+
+    if (!iEventsOpened)
+        return;
+
+    for (iEvent = 0; iEvent < EVENT_COUNT; iEvent++) {
+        if (aiEventFds[iEvent] >= 0) {
+            ioctl(aiEventFds[iEvent], PERF_EVENT_IOC_RESET, 0);
+            ioctl(aiEventFds[iEvent], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+/* Stops every open counter and adds its count to adCounts, or stores -1
+ * for events without a counter */
+static void stopEvents(double adCounts[]) {
+    unsigned long long aullValues[3];
+    int iEvent;
+
+    if (!iEventsOpened) {
+        for (iEvent = 0; iEvent < EVENT_COUNT; iEvent++)
+            adCounts[iEvent] = -1.0;
+        return;
+    }
+
+    for (iEvent = 0; iEvent < EVENT_COUNT; iEvent++) {
+        if (aiEventFds[iEvent] >= 0)
+            ioctl(aiEventFds[iEvent], PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    for (iEvent = 0; iEvent < EVENT_COUNT; iEvent++) {
+        if (aiEventFds[iEvent] < 0) {
+            adCounts[iEvent] = -1.0;
+            continue;
+        }
+
+        /* Value, time enabled, time running */
+        if (read(aiEventFds[iEvent], aullValues, sizeof(aullValues)) !=
+            (ssize_t)sizeof(aullValues) || aullValues[2] == 0)
+            continue;
+        adCounts[iEvent] += (double)aullValues[0] *
+                            ((double)aullValues[1] / (double)aullValues[2]);
+    }
+}
+
+#else
+
+/* Without perf_event_open no counters can be opened */
+static int openEvents(void) {
+    return 0;
+}
+
+static void startEvents(void) {
+}
+
+static void stopEvents(double adCounts[]) {
+    int iEvent;
+
+    for (iEvent = 0; iEvent < EVENT_COUNT; iEvent++)
+        adCounts[iEvent] = -1.0;
+}
+
+#endif
+
+/* Returns key uIndex of psKeys */
+static const char *keyAt(const KeySet *psKeys, size_t uIndex) {
+    return psKeys->pcKeys + uIndex * psKeys->uStride;
+}
+
+/* Allocates room for the 2 * uCount keys of psKeys, uStride bytes each.
+ * Returns 1 if successful, 0 if insufficient memory is available.
+ */
+static int allocKeys(KeySet *psKeys, size_t uCount, size_t uStride) {
+    psKeys->uCount = uCount;
+    psKeys->uStride = uStride;
+    psKeys->pcKeys = malloc(2 * uCount * uStride);
+    return psKeys->pcKeys != NULL;
+}
+
+/* Fills psKeys with the decimal strings "0", "1", ..., the keys
+ * testLargeTable uses.
+ * Returns 1 if successful, 0 if insufficient memory is available.
+ */
+static int makeSequentialKeys(KeySet *psKeys, size_t uCount) {
+    size_t i;
+
+    if (!allocKeys(psKeys, uCount, 24))
+        return 0;
+    for (i = 0; i < 2 * uCount; i++)
+        sprintf(psKeys->pcKeys + i * psKeys->uStride, "%lu", (unsigned long)i);
+    return 1;
+}
+
+/* Fills psKeys with 16-digit hexadecimal strings spread uniformly over
+ * all such strings.
+ * Returns 1 if successful, 0 if insufficient memory is available.
+ */
+static int makeRandomKeys(KeySet *psKeys, size_t uCount) {
+    size_t i;
+
+    if (!allocKeys(psKeys, uCount, 17))
+        return 0;
+    for (i = 0; i < 2 * uCount; i++)
+        sprintf(psKeys->pcKeys + i * psKeys->uStride, "%016llx",
+                scramble((unsigned long long)i));
+    return 1;
+}
+
+/* Fills psKeys with long dotted names, like the qualified symbol names
+ * of a compiler: a shared prefix, 16 hexadecimal digits spread uniformly
+ * over all such strings, and a shared suffix, 90 characters in all.
+ * Returns 1 if successful, 0 if insufficient memory is available.
+ */
+static int makeDottedKeys(KeySet *psKeys, size_t uCount) {
+    size_t i;
+
+    if (!allocKeys(psKeys, uCount, 91))
+        return 0;
+    for (i = 0; i < 2 * uCount; i++)
+        sprintf(psKeys->pcKeys + i * psKeys->uStride,
+                "org.example.compiler.backend.codegen.%016llx"
+                ".InstructionSelector.operand",
+                scramble((unsigned long long)i));
+    return 1;
+}
+
+/* Fills psKeys with keys that all have the same hash, at most
+ * ADVERSARIAL_MAX_COUNT of them put. Key i is the bits of i written
+ * as a sequence of acBlockA and acBlockB.
+ * Returns 1 if successful, 0 if insufficient memory is available.
+ */
+static int makeAdversarialKeys(KeySet *psKeys, size_t uCount) {
+    const size_t uBlockLength = sizeof(acBlockA) - 1;
+    size_t uBlocks = 1;
+    size_t uBit;
+    size_t i;
+    char *pcKey;
+
+    if (uCount > ADVERSARIAL_MAX_COUNT)
+        uCount = ADVERSARIAL_MAX_COUNT;
+
+    /* Enough blocks to give 2 * uCount distinct keys */
+    while (((size_t)1 << uBlocks) < 2 * uCount)
+        uBlocks++;
+
+    if (!allocKeys(psKeys, uCount, uBlocks * uBlockLength + 1))
+        return 0;
+    for (i = 0; i < 2 * uCount; i++) {
+        pcKey = psKeys->pcKeys + i * psKeys->uStride;
+        for (uBit = 0; uBit < uBlocks; uBit++)
+            memcpy(pcKey + uBit * uBlockLength,
+                   ((i >> uBit) & 1) ? acBlockB : acBlockA, uBlockLength);
+        pcKey[uBlocks * uBlockLength] = '\0';
+    }
+    return 1;
+}
+
+/* Stores a pseudo-random permutation of 0 .. uCount-1 in puIndexes */
+static void makePermutation(size_t *puIndexes, size_t uCount) {
+    size_t i;
+    size_t j;
+    size_t uTemp;
+
+    for (i = 0; i < uCount; i++)
+        puIndexes[i] = i;
+
+    /* Fisher-Yates shuffle */
+    for (i = uCount; i > 1; i--) {
+        j = randomIndex(i);
+        uTemp = puIndexes[i - 1];
+        puIndexes[i - 1] = puIndexes[j];
+        puIndexes[j] = uTemp;
+    }
+}
+
+/* Stores uCount indexes below uCount in puIndexes, drawn from a Zipfian
+ * distribution: the k-th most popular index is drawn with probability
+ * proportional to 1 / k^ZIPF_EXPONENT. Popularity is assigned to
+ * indexes at random rather than in insertion order.
+ * Returns 1 if successful, 0 if insufficient memory is available.
+ */
+static int makeZipfianAccess(size_t *puIndexes, size_t uCount) {
+    double *pdCumulative;
+    size_t *puRank;
+    double dTotal = 0.0;
+    double dTarget;
+    size_t uLow;
+    size_t uHigh;
+    size_t uMid;
+    size_t i;
+
+    pdCumulative = malloc(uCount * sizeof(double));
+    puRank = malloc(uCount * sizeof(size_t));
+    if (pdCumulative == NULL || puRank == NULL) {
+        free(pdCumulative);
+        free(puRank);
+        return 0;
+    }
+
+    for (i = 0; i < uCount; i++) {
+        dTotal += 1.0 / pow((double)(i + 1), ZIPF_EXPONENT);
+        pdCumulative[i] = dTotal;
+    }
+    makePermutation(puRank, uCount);
+
+    for (i = 0; i < uCount; i++) {
+        /* Find the first rank whose cumulative weight exceeds the target */
+        dTarget = randomUnit() * dTotal;
+        uLow = 0;
+        uHigh = uCount - 1;
+        while (uLow < uHigh) {
+            uMid = uLow + (uHigh - uLow) / 2;
+            if (pdCumulative[uMid] > dTarget)
+                uHigh = uMid;
+            else
+                uLow = uMid + 1;
+        }
+        puIndexes[i] = puRank[uLow];
+    }
+
+    free(pdCumulative);
+    free(puRank);
+    return 1;
+}
+
+/* Builds the workload named pcName with uCount bindings in *psWorkload.
+ * Returns 1 if successful, 0 if pcName is unknown or insufficient memory
+ * is available.
+ */
+static int makeWorkload(Workload *psWorkload, const char *pcName,
+                        size_t uCount) {
+    int iMade;
+    size_t i;
+
+    psWorkload->pcName = pcName;
+    psWorkload->sKeys.pcKeys = NULL;
+    psWorkload->puAccess = NULL;
+    psWorkload->puRemove = NULL;
+
+    if (strcmp(pcName, "sequential") == 0)
+        iMade = makeSequentialKeys(&psWorkload->sKeys, uCount);
+    else if (strcmp(pcName, "uniform") == 0 || strcmp(pcName, "zipfian") == 0)
+        iMade = makeRandomKeys(&psWorkload->sKeys, uCount);
+    else if (strcmp(pcName, "dotted") == 0)
+        iMade = makeDottedKeys(&psWorkload->sKeys, uCount);
+    else if (strcmp(pcName, "adversarial") == 0)
+        iMade = makeAdversarialKeys(&psWorkload->sKeys, uCount);
+    else
+        return 0;
+    if (!iMade)
+        return 0;
+
+    /* The adversarial key set may be smaller than asked for */
+    uCount = psWorkload->sKeys.uCount;
+    psWorkload->puAccess = malloc(uCount * sizeof(size_t));
+    psWorkload->puRemove = malloc(uCount * sizeof(size_t));
+    if (psWorkload->puAccess == NULL || psWorkload->puRemove == NULL)
+        return 0;
+
+    /* Sequential keys are accessed in insertion order, the others in a
+     * random order */
+    if (strcmp(pcName, "sequential") == 0) {
+        for (i = 0; i < uCount; i++) {
+            psWorkload->puAccess[i] = i;
+            psWorkload->puRemove[i] = i;
+        }
+        return 1;
+    }
+
+    makePermutation(psWorkload->puRemove, uCount);
+    if (strcmp(pcName, "zipfian") == 0)
+        return makeZipfianAccess(psWorkload->puAccess, uCount);
+    for (i = 0; i < uCount; i++)
+        psWorkload->puAccess[i] = randomIndex(uCount);
+    return 1;
+}
+
+/* Frees the memory held by psWorkload */
+static void freeWorkload(Workload *psWorkload) {
+    free(psWorkload->sKeys.pcKeys);
+    free(psWorkload->puAccess);
+    free(psWorkload->puRemove);
+}
+
+/* Counts the bindings visited by SymTable_map in *pvExtra, a size_t */
+static void countBinding(const char *pcKey, void *pvValue, void *pvExtra) {
+    (void)pcKey;
+    (void)pvValue;
+    (*(size_t *)pvExtra)++;
+}
+
+/* Allocates uSize bytes with malloc and adds them to *pvAllocExtra, a
+ * size_t holding the bytes currently allocated */
+static void *countingAlloc(size_t uSize, void *pvAllocExtra) {
+    *(size_t *)pvAllocExtra += uSize;
+    return malloc(uSize);
+}
+
+/* Frees pvBlock, allocated by countingAlloc with size uSize, and
+ * subtracts its size from *pvAllocExtra */
+static void countingFree(void *pvBlock, size_t uSize, void *pvAllocExtra) {
+    *(size_t *)pvAllocExtra -= uSize;
+    free(pvBlock);
+}
+
+/* Returns a new empty SymTable using pfTableHash or a random seed, if
+ * set, or NULL if insufficient memory is available */
+static SymTable_T newTable(void) {
+    if (iSeededTables)
+        return SymTable_newSeeded();
+    if (pfTableHash != NULL)
+        return SymTable_newWithHash(pfTableHash, NULL);
+    return SymTable_new();
+}
+
+/* Returns the number of calls that phase ePhase makes on a table of
+ * uCount bindings */
+static size_t callsIn(enum Phase ePhase, size_t uCount) {
+    if (ePhase == MAP)
+        return 1;
+    if (ePhase == BATCH_GET)
+        return (uCount + BATCH_SIZE - 1) / BATCH_SIZE;
+    return uCount;
+}
+
+/* Returns the number of keys that call i of phase ePhase handles on a
+ * table of uCount bindings: the whole table for a map, one batch (the
+ * last of which may be short) for a batch get, and one key otherwise */
+static size_t keysIn(enum Phase ePhase, size_t uCount, size_t i) {
+    if (ePhase == MAP)
+        return uCount;
+    if (ePhase == BATCH_GET)
+        return uCount - i * BATCH_SIZE < BATCH_SIZE ? uCount - i * BATCH_SIZE
+                                                    : BATCH_SIZE;
+    return 1;
+}
+
+/* Looks up keys i * BATCH_SIZE onwards of the hit-get order of
+ * psWorkload in oSymTable with one call of SymTable_getMany.
+ * Returns 1 if every key was found, 0 otherwise.
+ */
+static int getBatch(SymTable_T oSymTable, const Workload *psWorkload,
+                    size_t i) {
+    const char *apcKeys[BATCH_SIZE];
+    void *apvValues[BATCH_SIZE];
+    size_t uStart = i * BATCH_SIZE;
+    size_t uBatch = psWorkload->sKeys.uCount - uStart;
+    size_t j;
+
+    if (uBatch > BATCH_SIZE)
+        uBatch = BATCH_SIZE;
+    for (j = 0; j < uBatch; j++)
+        apcKeys[j] = keyAt(&psWorkload->sKeys,
+                           psWorkload->puAccess[uStart + j]);
+
+    return SymTable_getMany(oSymTable, apcKeys, uBatch, apvValues) == uBatch;
+}
+
+/* Makes call i of phase ePhase of psWorkload against oSymTable.
+ * Returns 1 if the call returned what it should, 0 otherwise.
+ */
+static int makeCall(SymTable_T oSymTable, const Workload *psWorkload,
+                    enum Phase ePhase, size_t i) {
+    const KeySet *psKeys = &psWorkload->sKeys;
+    size_t uMapped = 0;
+
+    /* Values are the keys' indexes plus one, so none is NULL */
+    switch (ePhase) {
+    case PUT:
+        return SymTable_put(oSymTable, keyAt(psKeys, i), (void *)(i + 1));
+    case HIT_GET:
+        return SymTable_get(oSymTable,
+                            keyAt(psKeys, psWorkload->puAccess[i])) != NULL;
+    case BATCH_GET:
+        return getBatch(oSymTable, psWorkload, i);
+    case MISS_GET:
+        return SymTable_get(oSymTable, keyAt(psKeys, psKeys->uCount + i)) == NULL;
+    case REPLACE:
+        return SymTable_replace(oSymTable,
+                                keyAt(psKeys, psWorkload->puAccess[i]),
+                                (void *)(i + 1)) != NULL;
+    case MAP:
+        SymTable_map(oSymTable, countBinding, &uMapped);
+        return uMapped == psKeys->uCount;
+    case REMOVE:
+        return SymTable_remove(oSymTable,
+                               keyAt(psKeys, psWorkload->puRemove[i])) != NULL;
+    default:
+        return 0;
+    }
+}
+
+/* Runs every phase of psWorkload uRounds times, each round against a
+ * new SymTable.
+ * If apfLatencies is NULL, times each phase as a whole and stores the
+ * mean costs in psResult->adMean and the mean event counts of any open
+ * counters in psResult->aadEvents. Otherwise times every call, storing
+ * the costs of phase p in apfLatencies[p].
+ * Returns 1 if successful, 0 if a call returns a wrong result or
+ * insufficient memory is available.
+ */
+static int runWorkload(const Workload *psWorkload, size_t uRounds,
+                       float *apfLatencies[], Result *psResult) {
+    const size_t uCount = psWorkload->sKeys.uCount;
+    const double dOverhead = apfLatencies == NULL ? 0.0 : clockOverhead();
+    SymTable_T oSymTable;
+    size_t uCalls;
+    size_t uRound;
+    size_t uSample;
+    size_t uWrong = 0;
+    double adTotal[PHASE_COUNT] = {0.0};
+    double aadEvents[PHASE_COUNT][EVENT_COUNT] = {{0.0}};
+    double dStart;
+    double dCallStart;
+    int iPhase;
+    size_t i;
+
+    for (uRound = 0; uRound < uRounds; uRound++) {
+        oSymTable = newTable();
+        if (oSymTable == NULL)
+            return 0;
+
+        for (iPhase = 0; iPhase < PHASE_COUNT; iPhase++) {
+            uCalls = callsIn((enum Phase)iPhase, uCount);
+            uSample = uRound * uCalls;
+
+            if (apfLatencies == NULL)
+                startEvents();
+            dStart = nowNs();
+            if (apfLatencies == NULL) {
+                for (i = 0; i < uCalls; i++)
+                    uWrong += !makeCall(oSymTable, psWorkload,
+                                        (enum Phase)iPhase, i);
+            }
+            else {
+                for (i = 0; i < uCalls; i++) {
+                    dCallStart = nowNs();
+                    uWrong += !makeCall(oSymTable, psWorkload,
+                                        (enum Phase)iPhase, i);
+                    dCallStart = nowNs() - dCallStart - dOverhead;
+                    if (dCallStart < 0.0)
+                        dCallStart = 0.0;
+                    apfLatencies[iPhase][uSample + i] =
+                        (float)(dCallStart /
+                                (double)keysIn((enum Phase)iPhase, uCount, i));
+                }
+            }
+            adTotal[iPhase] += nowNs() - dStart;
+            if (apfLatencies == NULL)
+                stopEvents(aadEvents[iPhase]);
+        }
+
+        SymTable_free(oSymTable);
+    }
+
+    if (apfLatencies == NULL) {
+        for (iPhase = 0; iPhase < PHASE_COUNT; iPhase++) {
+            psResult->adMean[iPhase] = adTotal[iPhase] /
+                                       (double)(uRounds * uCount);
+            for (i = 0; i < EVENT_COUNT; i++)
+                psResult->aadEvents[iPhase][i] =
+                    aadEvents[iPhase][i] < 0.0 ? -1.0 :
+                    aadEvents[iPhase][i] / (double)(uRounds * uCount);
+        }
+    }
+
+    return uWrong == 0;
+}
+
+/* Puts every key of psWorkload into a table with a counting allocator
+ * and stores the bytes it allocated per binding in
+ * psResult->dBytesPerBinding. The hash function does not change them.
+ * Returns 1 if successful, 0 if insufficient memory is available.
+ */
+static int measureBytes(const Workload *psWorkload, Result *psResult) {
+    const size_t uCount = psWorkload->sKeys.uCount;
+    SymTable_T oSymTable;
+    size_t uBytes = 0;
+    size_t i;
+    int iMeasured = 1;
+
+    oSymTable = SymTable_newWithAllocator(countingAlloc, countingFree,
+                                          &uBytes);
+    if (oSymTable == NULL)
+        return 0;
+    for (i = 0; i < uCount && iMeasured; i++)
+        iMeasured = makeCall(oSymTable, psWorkload, PUT, i);
+    psResult->dBytesPerBinding = (double)uBytes / (double)uCount;
+
+    SymTable_free(oSymTable);
+    return iMeasured;
+}
+
+/* Measures psWorkload: mean costs from one run of uRounds rounds, then
+ * percentiles from a second run that times every call, then bytes per
+ * binding. Stores the measurements in *psResult.
+ * Returns 1 if successful, 0 if a call returns a wrong result or
+ * insufficient memory is available.
+ */
+static int measureWorkload(const Workload *psWorkload, size_t uRounds,
+                           Result *psResult) {
+    const size_t uCount = psWorkload->sKeys.uCount;
+    float *apfLatencies[PHASE_COUNT];
+    size_t uSamples;
+    int iPhase;
+    int iMeasured;
+
+    for (iPhase = 0; iPhase < PHASE_COUNT; iPhase++)
+        apfLatencies[iPhase] = malloc(uRounds * uCount * sizeof(float));
+
+    iMeasured = runWorkload(psWorkload, uRounds, NULL, psResult);
+    for (iPhase = 0; iPhase < PHASE_COUNT && iMeasured; iPhase++)
+        iMeasured = apfLatencies[iPhase] != NULL;
+    if (iMeasured)
+        iMeasured = runWorkload(psWorkload, uRounds, apfLatencies, psResult);
+    if (iMeasured)
+        iMeasured = measureBytes(psWorkload, psResult);
+
+    for (iPhase = 0; iPhase < PHASE_COUNT && iMeasured; iPhase++) {
+        uSamples = uRounds * callsIn((enum Phase)iPhase, uCount);
+        qsort(apfLatencies[iPhase], uSamples, sizeof(float), compareFloats);
+        psResult->adP50[iPhase] = apfLatencies[iPhase][uSamples * 50 / 100];
+        psResult->adP99[iPhase] = apfLatencies[iPhase][uSamples * 99 / 100];
+    }
+
+    for (iPhase = 0; iPhase < PHASE_COUNT; iPhase++)
+        free(apfLatencies[iPhase]);
+    return iMeasured;
+}
+
+/* Writes the measurements of psWorkload in psResult to stdout, as one
+ * row of the report table followed by a row per event if iEvents, or as
+ * one CSV record per phase if iCsv */
+static void writeResult(const Workload *psWorkload, const Result *psResult,
+                        int iCsv, int iEvents) {
+    int iPhase;
+    int iEvent;
+
+    if (!iCsv) {
+        printf("%-12s %9lu", psWorkload->pcName,
+               (unsigned long)psWorkload->sKeys.uCount);
+        for (iPhase = 0; iPhase < PHASE_COUNT; iPhase++)
+            printf(" %9.1f", psResult->adMean[iPhase]);
+        printf(" %9.1f\n", psResult->dBytesPerBinding);
+
+        for (iEvent = 0; iEvents && iEvent < EVENT_COUNT; iEvent++) {
+            printf("  %-20s", apcEventNames[iEvent]);
+            for (iPhase = 0; iPhase < PHASE_COUNT; iPhase++) {
+                if (psResult->aadEvents[iPhase][iEvent] < 0.0)
+                    printf(" %9s", "n/a");
+                else
+                    printf(" %9.2f", psResult->aadEvents[iPhase][iEvent]);
+            }
+            printf("\n");
+        }
+        return;
+    }
+
+    for (iPhase = 0; iPhase < PHASE_COUNT; iPhase++)
+        printf("%s,%lu,%s,%.1f,%.2f,%.0f,%.0f,%.1f\n", psWorkload->pcName,
+               (unsigned long)psWorkload->sKeys.uCount, apcPhaseNames[iPhase],
+               psResult->adMean[iPhase], 1e3 / psResult->adMean[iPhase],
+               psResult->adP50[iPhase], psResult->adP99[iPhase],
+               psResult->dBytesPerBinding);
+}
+
+/* Runs the workloads named by the distribution argument (default: all
+ * of them) with bindingcount (default DEFAULT_COUNT) bindings each.
+ * Writes a table of mean ns per call and bytes per binding to stdout;
+ * with -perf, each row is followed by the mean count of each hardware
+ * event per call. With -csv, writes one CSV record per workload and
+ * phase instead, adding throughput in millions of calls per second and
+ * the p50 and p99 cost of single calls, less the median cost of reading
+ * the clock. With -wyhash, the tables hash keys with SymTable_hashWyhash
+ * instead of the implementation's own hash; with -seeded, the tables are
+ * made by SymTable_newSeeded.
+ * Returns 0, or EXIT_FAILURE on bad arguments, a wrong result, or no
+ * memory.
+ */
+int main(int argc, char *argv[]) {
+    static const char *apcNames[] = {
+        "sequential", "uniform", "zipfian", "dotted", "adversarial"
+    };
+    const size_t uNameCount = sizeof(apcNames) / sizeof(apcNames[0]);
+    Workload sWorkload;
+    Result sResult;
+    long lCount = DEFAULT_COUNT;
+    const char *pcOnly = NULL;
+    size_t uRounds;
+    size_t i;
+    int iArg = 1;
+    int iCsv = 0;
+    int iEvents = 0;
+    int iPhase;
+    int iRan = 0;
+
+    if (iArg < argc && strcmp(argv[iArg], "-csv") == 0) {
+        iCsv = 1;
+        iArg++;
+    }
+    else if (iArg < argc && strcmp(argv[iArg], "-perf") == 0) {
+        iEvents = 1;
+        iArg++;
+    }
+    if (iArg < argc && strcmp(argv[iArg], "-wyhash") == 0) {
+        pfTableHash = SymTable_hashWyhash;
+        iArg++;
+    }
+    else if (iArg < argc && strcmp(argv[iArg], "-seeded") == 0) {
+        iSeededTables = 1;
+        iArg++;
+    }
+    if (iArg < argc && (sscanf(argv[iArg++], "%ld", &lCount) != 1 ||
+                        lCount <= 0))
+        iArg = argc + 1;
+    if (iArg < argc)
+        pcOnly = argv[iArg++];
+    if (iArg != argc) {
+        fprintf(stderr, "Usage: %s [-csv|-perf] [-wyhash|-seeded] [bindingcount "
+                "[sequential|uniform|zipfian|dotted|adversarial]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (iEvents && openEvents() == 0) {
+        fprintf(stderr, "%s: no performance counters available\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (iCsv)
+        printf("distribution,bindings,operation,ns_per_call,mcalls_per_s,"
+               "p50_ns,p99_ns,bytes_per_binding\n");
+    else {
+        printf("%s: ns per call (map: per binding, batch-get: per key)%s\n", argv[0],
+               iEvents ? ", then events per call" : "");
+        printf("%-12s %9s", "distribution", "bindings");
+        for (iPhase = 0; iPhase < PHASE_COUNT; iPhase++)
+            printf(" %9s", apcPhaseNames[iPhase]);
+        printf(" %9s\n", "bytes");
+    }
+
+    for (i = 0; i < uNameCount; i++) {
+        if (pcOnly != NULL && strcmp(pcOnly, apcNames[i]) != 0)
+            continue;
+        iRan = 1;
+
+        if (!makeWorkload(&sWorkload, apcNames[i], (size_t)lCount)) {
+            fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+            freeWorkload(&sWorkload);
+            return EXIT_FAILURE;
+        }
+
+        uRounds = (MIN_CALLS + sWorkload.sKeys.uCount - 1) /
+                  sWorkload.sKeys.uCount;
+        if (!measureWorkload(&sWorkload, uRounds, &sResult)) {
+            fprintf(stderr, "%s: %s workload failed\n", argv[0], apcNames[i]);
+            freeWorkload(&sWorkload);
+            return EXIT_FAILURE;
+        }
+
+        writeResult(&sWorkload, &sResult, iCsv, iEvents);
+        fflush(stdout);
+        freeWorkload(&sWorkload);
+    }
+
+    if (!iRan) {
+        fprintf(stderr, "%s: unknown distribution %s\n", argv[0], pcOnly);
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
@@ -18,6 +18,81 @@ typedef struct SymTable *SymTable_T;
  */
 SymTable_T SymTable_new(void);
 
+/* Creates and returns a new empty symbol table sized to hold uCapacity
+ * bindings without resizing.
+ * Returns NULL if insufficient memory is available.
+ */
+SymTable_T SymTable_newWithCapacity(size_t uCapacity);
+
+/* Creates and returns a new empty symbol table in arena mode: its
+ * bindings and key copies are carved from large slabs owned by the
+ * table, removed bindings are reused by later puts, and SymTable_free
+ * releases the slabs in bulk instead of freeing each binding.
+ * Returns NULL if insufficient memory is available.
+ */
+SymTable_T SymTable_newArena(void);
+
+/* Creates and returns a new empty symbol table that gets all of its
+ * memory (the table itself, its internal arrays, its bindings and key
+ * copies) from pfAlloc and returns it through pfFree instead of using
+ * malloc and free. pfAlloc returns a block of at least uSize bytes,
+ * suitably aligned for any object, or NULL if none is available.
+ * pfFree receives the size the block was allocated with. Both are
+ * passed pvAllocExtra.
+ * Returns NULL if insufficient memory is available.
+ * pfAlloc and pfFree must not be NULL.
+ */
+SymTable_T SymTable_newWithAllocator(
+    void *(*pfAlloc)(size_t uSize, void *pvAllocExtra),
+    void (*pfFree)(void *pvBlock, size_t uSize, void *pvAllocExtra),
+    void *pvAllocExtra);
+
+/* Creates and returns a new empty symbol table that hashes keys with
+ * pfHash instead of its built-in hash. pfHash returns the hash of pcKey,
+ * whose length is uKeyLength, and is passed pvHashExtra. Equal keys must
+ * have equal hashes, and the table works best when every bit of the
+ * hash depends on every byte of the key.
+ * Returns NULL if insufficient memory is available.
+ * pfHash must not be NULL.
+ */
+SymTable_T SymTable_newWithHash(
+    size_t (*pfHash)(const char *pcKey, size_t uKeyLength,
+                     const void *pvHashExtra),
+    const void *pvHashExtra);
+
+/* The hash of the assignment specification, computed a byte at a time:
+ * the hash every table uses unless created with SymTable_newWithHash.
+ * Ignores pvHashExtra.
+ * pcKey must not be NULL.
+ */
+size_t SymTable_hash65599(const char *pcKey, size_t uKeyLength,
+                          const void *pvHashExtra);
+
+/* A wyhash hash, which reads the key 8 or 16 bytes at a time and so is
+ * much faster than SymTable_hash65599 for long keys. pvHashExtra points
+ * to an unsigned long long seed, or is NULL for seed 0.
+ * pcKey must not be NULL.
+ */
+size_t SymTable_hashWyhash(const char *pcKey, size_t uKeyLength,
+                           const void *pvHashExtra);
+
+/* The SipHash-1-3 keyed hash. Without its 128-bit key, whoever chooses
+ * the keys of a table cannot choose ones that collide. pvHashExtra points
+ * to the key, an array of two unsigned long long.
+ * pcKey and pvHashExtra must not be NULL.
+ */
+size_t SymTable_hashSiphash13(const char *pcKey, size_t uKeyLength,
+                              const void *pvHashExtra);
+
+/* Creates and returns a new empty symbol table for keys from untrusted
+ * input. It hashes keys with SymTable_hashSiphash13 under a key drawn at
+ * random for this table, so that no one can craft keys that collide in
+ * it and slow its operations to a search of every binding. Hashing costs
+ * more than the built-in hash, but no key set is slower than average.
+ * Returns NULL if insufficient memory is available.
+ */
+SymTable_T SymTable_newSeeded(void);
+
 /* Frees all memory occupied by oSymTable, including all keys.
  * Does not free memory occupied by the values stored in the table.
  * oSymTable must not be NULL.
@@ -29,6 +104,17 @@ void SymTable_free(SymTable_T oSymTable);
  */
 size_t SymTable_getLength(SymTable_T oSymTable);
 
+/* Ensures oSymTable can hold uCapacity bindings without resizing, by
+ * resizing it at most once now. A table does not shrink below a
+ * reserved capacity. In a hash table built with -DSYMTABLE_REHASH_STEP,
+ * this first finishes any resize in progress, which can take time
+ * proportional to the number of bindings.
+ * Returns 1 (true) if successful, 0 (false) if insufficient memory is
+ * available, in which case oSymTable is unchanged.
+ * oSymTable must not be NULL.
+ */
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity);
+
 /* Adds a new binding to oSymTable consisting of key pcKey and value pvValue.
  * Makes a defensive copy of pcKey.
  * Returns 1 (true) if the binding was added successfully.
@@ -65,6 +151,99 @@ void *SymTable_get(SymTable_T oSymTable, const char *pcKey);
  */
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey);
 
+/* Binds pcKey to pvValue in oSymTable, adding a binding if pcKey is not
+ * in oSymTable and replacing the value of its binding otherwise, with a
+ * single search for pcKey. Makes a defensive copy of pcKey if it adds a
+ * binding. If it replaces a value and ppvOldValue is not NULL, stores
+ * the old value in *ppvOldValue.
+ * Returns 1 if a binding was added, 0 if a value was replaced, or -1 if
+ * insufficient memory is available, in which case oSymTable is unchanged.
+ * oSymTable and pcKey must not be NULL.
+ */
+int SymTable_upsert(SymTable_T oSymTable, const char *pcKey, const void *pvValue,
+                    void **ppvOldValue);
+
+/* Returns the value bound to pcKey in oSymTable, first adding a binding
+ * of pcKey to pvValue if there is none, with a single search for pcKey.
+ * Makes a defensive copy of pcKey if it adds a binding. If piAdded is not
+ * NULL, stores in *piAdded 1 if a binding was added, 0 if pcKey was
+ * already bound, or -1 if insufficient memory is available, in which
+ * case oSymTable is unchanged and NULL is returned.
+ * oSymTable and pcKey must not be NULL.
+ */
+void *SymTable_getOrPut(SymTable_T oSymTable, const char *pcKey,
+                        const void *pvValue, int *piAdded);
+
+/* Returns the value associated with key pcKey in oSymTable, and stores in
+ * *piFound 1 (true) if such a binding exists, 0 (false) otherwise, so
+ * that a missing key can be told apart from a NULL value.
+ * Returns NULL if no such binding exists.
+ * oSymTable, pcKey and piFound must not be NULL.
+ */
+void *SymTable_getFound(SymTable_T oSymTable, const char *pcKey, int *piFound);
+
+/* Returns a pointer to the value of the binding in oSymTable with key
+ * pcKey, first adding a binding of pcKey to NULL if there is none, with a
+ * single search for pcKey, so that a value can be read and updated in
+ * place. Makes a defensive copy of pcKey if it adds a binding. If
+ * piCreated is not NULL, stores in *piCreated 1 (true) if a binding was
+ * added, 0 (false) otherwise. The pointer is valid until the next call
+ * that adds or removes a binding of oSymTable or resizes it.
+ * Returns NULL if insufficient memory is available, in which case
+ * oSymTable is unchanged.
+ * oSymTable and pcKey must not be NULL.
+ */
+void **SymTable_entry(SymTable_T oSymTable, const char *pcKey, int *piCreated);
+
+/* Looks up each of the uCount keys apcKeys[0..uCount-1] in oSymTable,
+ * storing in apvValues[i] the value associated with apcKeys[i], or NULL
+ * if no such binding exists. The searches for different keys overlap
+ * their cache misses, so a batch of lookups in a table much larger than
+ * the cache takes less time than as many calls of SymTable_get.
+ * Returns the number of keys found.
+ * oSymTable, apcKeys, apvValues and each of apcKeys[0..uCount-1] must
+ * not be NULL.
+ */
+size_t SymTable_getMany(SymTable_T oSymTable, const char *apcKeys[],
+                        size_t uCount, void *apvValues[]);
+
+/* Largest batch width that SymTable_getManyInterleaved accepts */
+enum { SYMTABLE_MAX_INTERLEAVE = 64 };
+
+/* Does what SymTable_getMany does, keeping up to uWidth searches in
+ * flight at once. Each search is a small state machine that a round
+ * robin advances by one cache line (a bucket, or a binding of a hash
+ * chain) at a time, prefetching the next line before moving on to the
+ * next search, and a finished search is replaced by the next key at
+ * once. So long chains overlap their misses with each other, and uWidth
+ * can be tuned to the memory system. symtablerobin.c and symtableswiss.c,
+ * whose probes seldom leave their first cache line, overlap batches of
+ * uWidth keys instead, and symtablelist.c searches one key at a time.
+ * Returns the number of keys found.
+ * oSymTable, apcKeys, apvValues and each of apcKeys[0..uCount-1] must
+ * not be NULL, and uWidth must be at least 1 and at most
+ * SYMTABLE_MAX_INTERLEAVE.
+ */
+size_t SymTable_getManyInterleaved(SymTable_T oSymTable, const char *apcKeys[],
+                                   size_t uCount, void *apvValues[],
+                                   size_t uWidth);
+
+/* Adds to oSymTable a binding of each of the uCount keys
+ * apcKeys[0..uCount-1] to the value apvValues[i], as SymTable_put does,
+ * except that it first grows oSymTable once to hold them all instead of
+ * growing step by step as the bindings are added; like SymTable_reserve,
+ * that growth first finishes any resize in progress. Makes a defensive copy
+ * of each key added. If aiAdded is not NULL, stores in aiAdded[i] 1
+ * (true) if apcKeys[i] was added, or 0 (false) if it already existed
+ * in oSymTable (or earlier in apcKeys) or insufficient memory was
+ * available.
+ * Returns the number of bindings added.
+ * oSymTable, apcKeys, apvValues and each of apcKeys[0..uCount-1] must
+ * not be NULL.
+ */
+size_t SymTable_putMany(SymTable_T oSymTable, const char *apcKeys[],
+                        const void *apvValues[], size_t uCount, int aiAdded[]);
+
 /* Applies function pfApply to each binding in oSymTable.
  * For each binding, calls pfApply(pcKey, pvValue, pvExtra).
  * oSymTable and pfApply must not be NULL.
@@ -73,4 +252,151 @@ void SymTable_map(SymTable_T oSymTable,
      void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
      const void *pvExtra);
 
+/* Applies function pfApply to each binding in oSymTable, as
+ * SymTable_map does, but splits the table among up to uThreads threads,
+ * which call pfApply(pcKey, pvValue, pvExtra) at the same time for
+ * different bindings. pfApply must therefore be safe to call from
+ * several threads at once, for example by only reading shared data or
+ * by updating it under a lock or atomically, and must not change
+ * oSymTable. pfApply may look keys up in oSymTable, which only reads it,
+ * unless oSymTable was built with -DSYMTABLE_TRACE, which records every
+ * call in the table. The calling thread does part of the work, and does
+ * all of it in symtablelist.c, whose list cannot be split without
+ * walking it.
+ * oSymTable and pfApply must not be NULL, and uThreads must be at
+ * least 1.
+ */
+void SymTable_mapParallel(SymTable_T oSymTable,
+                          void (*pfApply)(const char *pcKey, void *pvValue,
+                                          void *pvExtra),
+                          const void *pvExtra, size_t uThreads);
+
+/* SymTableIter_T is an opaque pointer to an iterator over the bindings
+ * of a symbol table, which yields each binding once, in no particular
+ * order. While an iterator is in use, its table may have values
+ * replaced, but must not have bindings added or removed or be reserved
+ * or freed.
+ */
+typedef struct SymTableIter *SymTableIter_T;
+
+/* Creates and returns an iterator positioned before the first binding
+ * of oSymTable.
+ * Returns NULL if insufficient memory is available.
+ * oSymTable must not be NULL.
+ */
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable);
+
+/* Advances oIter to the next binding of its table and stores that
+ * binding's key in *ppcKey and value in *ppvValue, skipping either if
+ * its pointer is NULL. The key belongs to the table.
+ * Returns 1 (true) if there was a next binding, 0 (false) if every
+ * binding has been visited, in which case *ppcKey and *ppvValue are
+ * unchanged.
+ * oIter must not be NULL.
+ */
+int SymTable_iterNext(SymTableIter_T oIter, const char **ppcKey,
+                      void **ppvValue);
+
+/* Frees oIter, whether or not it has visited every binding.
+ * oIter must not be NULL.
+ */
+void SymTable_iterEnd(SymTableIter_T oIter);
+
+/* Number of entries in the chain-length histogram of SymTable_Stats */
+enum { SYMTABLE_HISTOGRAM_SIZE = 16 };
+
+/* A SymTable_Stats structure describes the internal state of a symbol
+ * table, as reported by SymTable_getStats. A bucket is the set of
+ * bindings whose search starts at the same place, and its chain length
+ * is the number of bindings in it: a hash chain (symtablehash.c), the
+ * bindings sharing a home slot (symtablerobin.c) or a home group
+ * (symtableswiss.c), or the whole list (symtablelist.c).
+ */
+typedef struct SymTable_Stats {
+    /* Number of bindings */
+    size_t uLength;
+    /* Number of buckets */
+    size_t uBucketCount;
+    /* Number of growth steps of the bucket count above the smallest,
+     * which in symtablehash.c is the index into its prime sequence, or
+     * the number of doublings if built with -DSYMTABLE_POW2 */
+    size_t uGrowthStep;
+    /* Number of buckets holding no bindings */
+    size_t uEmptyBuckets;
+    /* Length of the longest chain */
+    size_t uMaxChainLength;
+    /* Mean length of the chains that are not empty */
+    double dMeanChainLength;
+    /* Entry i is the number of buckets whose chain length is i; the last
+     * entry counts every chain of SYMTABLE_HISTOGRAM_SIZE - 1 or more */
+    size_t auChainLengths[SYMTABLE_HISTOGRAM_SIZE];
+    /* Number of times the bucket count has grown and shrunk */
+    size_t uExpansions;
+    size_t uShrinks;
+    /* Number of bindings, slots or groups examined by searches for
+     * keys, and the number of key comparisons those searches made, since
+     * the table was created. Only a table built with -DSYMTABLE_TRACE
+     * counts them, so that elsewhere a lookup never writes to its table;
+     * both are 0 otherwise. */
+    size_t uProbes;
+    size_t uKeyCompares;
+} SymTable_Stats;
+
+/* Fills *psStats with a description of the internal state of oSymTable,
+ * in time proportional to the number of buckets.
+ * Returns 1 (true) if successful, 0 (false) if insufficient memory is
+ * available, in which case *psStats is unchanged.
+ * oSymTable and psStats must not be NULL.
+ */
+int SymTable_getStats(SymTable_T oSymTable, SymTable_Stats *psStats);
+
+/* The operations whose latencies a table built with -DSYMTABLE_TRACE
+ * records. An operation that grows or shrinks the table is recorded as a
+ * SYMTABLE_OP_RESIZE rather than under its own name, so that the cost of
+ * resizing shows up in a histogram of its own. */
+enum SymTable_Op {
+    SYMTABLE_OP_GET_LENGTH,
+    SYMTABLE_OP_RESERVE,
+    SYMTABLE_OP_PUT,
+    SYMTABLE_OP_REPLACE,
+    SYMTABLE_OP_CONTAINS,
+    SYMTABLE_OP_GET,
+    SYMTABLE_OP_REMOVE,
+    SYMTABLE_OP_MAP,
+    SYMTABLE_OP_UPSERT,
+    SYMTABLE_OP_GET_OR_PUT,
+    SYMTABLE_OP_GET_FOUND,
+    SYMTABLE_OP_ENTRY,
+    SYMTABLE_OP_GET_MANY,
+    SYMTABLE_OP_GET_MANY_INTERLEAVED,
+    SYMTABLE_OP_PUT_MANY,
+    SYMTABLE_OP_MAP_PARALLEL,
+    SYMTABLE_OP_RESIZE,
+    SYMTABLE_OP_COUNT
+};
+
+/* Number of buckets in a latency histogram. Buckets are log-linear: each
+ * power of two of ticks is split into 8 equal buckets, and the last
+ * bucket counts every latency too large for the others. */
+enum { SYMTABLE_LATENCY_BUCKETS = 304 };
+
+/* Copies into aulCounts the latency histogram of operation eOp on
+ * oSymTable: entry i is the number of calls whose latency, in ticks of
+ * the processor's time stamp counter (or of clock() where there is none
+ * to read), was at least SymTable_latencyBucketStart(i) and less than
+ * that of entry i + 1.
+ * Returns 1 (true) if oSymTable was built with -DSYMTABLE_TRACE, 0
+ * (false) otherwise, in which case aulCounts is unchanged.
+ * oSymTable and aulCounts must not be NULL, and eOp must be less than
+ * SYMTABLE_OP_COUNT.
+ */
+int SymTable_getLatencyHistogram(SymTable_T oSymTable, enum SymTable_Op eOp,
+                                 unsigned long aulCounts[]);
+
+/* Returns the smallest latency, in ticks, counted by bucket uBucket of a
+ * latency histogram.
+ * uBucket must be less than SYMTABLE_LATENCY_BUCKETS.
+ */
+unsigned long long SymTable_latencyBucketStart(size_t uBucket);
+
 #endif
\ No newline at end of file
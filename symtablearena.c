@@ -0,0 +1,213 @@
+/* Author: Nicholas Budny */
+
+/* symtablearena.c - Implementation of the Arena ADT */
+
+#include <assert.h>
+#include <stdlib.h>
+#include "symtablearena.h"
+
+/* Block sizes are rounded up to a multiple of this many bytes, which
+ * also keeps every block aligned for any object */
+enum { GRANULE = 16 };
+
+/* Blocks up to CLASS_COUNT granules are recycled through a free list per
+ * size; larger blocks are rare enough to take straight from malloc and
+ * give straight back to free, which neither scans for a fit nor hands
+ * out blocks bigger than asked for */
+enum { CLASS_COUNT = 32 };
+
+/* Number of bytes in a regular slab */
+enum { SLAB_SIZE = 64 * 1024 };
+
+/* A Slab is the header of one allocation from malloc. Its blocks start
+ * GRANULE bytes after the header, so they stay aligned.
+ */
+typedef struct Slab {
+    /* Next slab owned by the same arena */
+    struct Slab *pNext;
+} Slab;
+
+/* A FreeBlock is the first bytes of a released block of a size class */
+typedef struct FreeBlock {
+    /* Next released block of the same size class */
+    struct FreeBlock *pNext;
+} FreeBlock;
+
+/* A LargeBlock is the header of an allocation from malloc holding one
+ * block too large for any size class. The block starts GRANULE bytes
+ * after the header. The list is doubly linked so that a block can leave
+ * it in constant time when released.
+ */
+typedef struct LargeBlock {
+    /* Previous and next large block in use in the same arena */
+    struct LargeBlock *pPrev;
+    struct LargeBlock *pNext;
+} LargeBlock;
+
+/* The Arena structure represents the slabs and the recycled blocks. */
+struct Arena {
+    /* List of all slabs owned by the arena */
+    Slab *pSlabs;
+    /* Next unused byte of the current regular slab */
+    char *pcNext;
+    /* End of the current regular slab */
+    char *pcEnd;
+    /* Free list for each size class, indexed by granule count - 1 */
+    FreeBlock *apFree[CLASS_COUNT];
+    /* List of the large blocks in use */
+    LargeBlock *pLarge;
+};
+
+/* Returns uSize rounded up to a whole number of granules (at least one) */
+static size_t Arena_roundUp(size_t uSize) {
+    if (uSize == 0)
+        return GRANULE;
+    return (uSize + GRANULE - 1) / GRANULE * GRANULE;
+}
+
+/* Allocates a slab with uPayload usable bytes and links it into oArena.
+ * Returns the first usable byte, or NULL if insufficient memory is
+ * available.
+ */
+static char *Arena_addSlab(Arena_T oArena, size_t uPayload) {
+    Slab *pSlab;
+
+    assert(oArena != NULL);
+
+    if (uPayload > (size_t)-1 - GRANULE)
+        return NULL;
+
+    pSlab = malloc(GRANULE + uPayload);
+    if (pSlab == NULL)
+        return NULL;
+
+    pSlab->pNext = oArena->pSlabs;
+    oArena->pSlabs = pSlab;
+
+    return (char *)pSlab + GRANULE;
+}
+
+/* Allocates a block of uSize bytes, too large for any size class, with
+ * a header of its own and links it into oArena.
+ * Returns the block, or NULL if insufficient memory is available.
+ */
+static void *Arena_allocLarge(Arena_T oArena, size_t uSize) {
+    LargeBlock *pLarge;
+
+    assert(oArena != NULL);
+
+    if (uSize > (size_t)-1 - GRANULE)
+        return NULL;
+
+    pLarge = malloc(GRANULE + uSize);
+    if (pLarge == NULL)
+        return NULL;
+
+    pLarge->pPrev = NULL;
+    pLarge->pNext = oArena->pLarge;
+    if (oArena->pLarge != NULL)
+        oArena->pLarge->pPrev = pLarge;
+    oArena->pLarge = pLarge;
+
+    return (char *)pLarge + GRANULE;
+}
+
+Arena_T Arena_new(void) {
+    Arena_T oArena;
+    size_t i;
+
+    oArena = malloc(sizeof(struct Arena));
+    if (oArena == NULL)
+        return NULL;
+
+    oArena->pSlabs = NULL;
+    oArena->pcNext = NULL;
+    oArena->pcEnd = NULL;
+    for (i = 0; i < CLASS_COUNT; i++)
+        oArena->apFree[i] = NULL;
+    oArena->pLarge = NULL;
+
+    return oArena;
+}
+
+void Arena_free(Arena_T oArena) {
+    Slab *pSlab;
+    Slab *pNext;
+    LargeBlock *pLarge;
+    LargeBlock *pNextLarge;
+
+    assert(oArena != NULL);
+
+    for (pSlab = oArena->pSlabs; pSlab != NULL; pSlab = pNext) {
+        pNext = pSlab->pNext;
+        free(pSlab);
+    }
+    for (pLarge = oArena->pLarge; pLarge != NULL; pLarge = pNextLarge) {
+        pNextLarge = pLarge->pNext;
+        free(pLarge);
+    }
+
+    free(oArena);
+}
+
+void *Arena_alloc(Arena_T oArena, size_t uSize) {
+    size_t uClass;
+    char *pcBlock;
+
+    assert(oArena != NULL);
+
+    uSize = Arena_roundUp(uSize);
+    uClass = uSize / GRANULE - 1;
+
+    if (uClass >= CLASS_COUNT)
+        return Arena_allocLarge(oArena, uSize);
+
+    /* Reuse a released block of the same size class */
+    if (oArena->apFree[uClass] != NULL) {
+        pcBlock = (char *)oArena->apFree[uClass];
+        oArena->apFree[uClass] = oArena->apFree[uClass]->pNext;
+        return pcBlock;
+    }
+
+    /* Otherwise carve the block from the current slab, starting a new
+     * slab when it runs out; the current slab's tail is abandoned */
+    if (oArena->pcNext == NULL || (size_t)(oArena->pcEnd - oArena->pcNext) < uSize) {
+        oArena->pcNext = Arena_addSlab(oArena, SLAB_SIZE);
+        if (oArena->pcNext == NULL)
+            return NULL;
+        oArena->pcEnd = oArena->pcNext + SLAB_SIZE;
+    }
+
+    pcBlock = oArena->pcNext;
+    oArena->pcNext += uSize;
+    return pcBlock;
+}
+
+void Arena_release(Arena_T oArena, void *pvBlock, size_t uSize) {
+    size_t uClass;
+    FreeBlock *pFree;
+    LargeBlock *pLarge;
+
+    assert(oArena != NULL);
+    assert(pvBlock != NULL);
+
+    uSize = Arena_roundUp(uSize);
+    uClass = uSize / GRANULE - 1;
+
+    /* A large block goes straight back to free */
+    if (uClass >= CLASS_COUNT) {
+        pLarge = (LargeBlock *)((char *)pvBlock - GRANULE);
+        if (pLarge->pPrev != NULL)
+            pLarge->pPrev->pNext = pLarge->pNext;
+        else
+            oArena->pLarge = pLarge->pNext;
+        if (pLarge->pNext != NULL)
+            pLarge->pNext->pPrev = pLarge->pPrev;
+        free(pLarge);
+        return;
+    }
+
+    pFree = pvBlock;
+    pFree->pNext = oArena->apFree[uClass];
+    oArena->apFree[uClass] = pFree;
+}
@@ -0,0 +1,44 @@
+/* Author: Nicholas Budny */
+
+/* symtablearena.h - declaration of the Arena ADT, a slab allocator that
+ * SymTable implementations use for bindings and keys in arena mode */
+
+#ifndef SYMTABLEARENA_H
+#define SYMTABLEARENA_H
+
+#include <stddef.h>
+
+/* Arena_T is an opaque pointer to an arena.
+ * An arena carves small blocks out of large slabs and recycles released
+ * ones through free lists, gives each larger block an allocation of its
+ * own, and frees everything at once.
+ */
+typedef struct Arena *Arena_T;
+
+/* Creates and returns a new arena that owns no slabs yet.
+ * Returns NULL if insufficient memory is available.
+ */
+Arena_T Arena_new(void);
+
+/* Frees every slab of oArena, and with them every block allocated from
+ * oArena, in time proportional to the number of slabs and of large
+ * blocks not yet released.
+ * oArena must not be NULL.
+ */
+void Arena_free(Arena_T oArena);
+
+/* Returns a block of at least uSize bytes from oArena, suitably aligned
+ * for any object.
+ * Returns NULL if insufficient memory is available.
+ * oArena must not be NULL.
+ */
+void *Arena_alloc(Arena_T oArena, size_t uSize);
+
+/* Returns the block pvBlock, which was allocated from oArena with size
+ * uSize, to oArena for reuse by later calls to Arena_alloc, or frees it
+ * at once if it is too large for a size class.
+ * oArena and pvBlock must not be NULL.
+ */
+void Arena_release(Arena_T oArena, void *pvBlock, size_t uSize);
+
+#endif
@@ -6,25 +6,94 @@
 #include <stdlib.h>
 #include <string.h>
 #include "symtable.h"
+#include "symtablearena.h"
+#include "symtablehashfn.h"
+#include "symtableparallel.h"
+#include "symtabletrace.h"
 
-/* Array of prime numbers for bucket counts during hash table expansion */
+/* Bucket counts are primes, and a hash is reduced to a bucket index by
+ * taking it modulo the bucket count. Build with -DSYMTABLE_POW2 to use
+ * powers of two instead, reduced by a multiply and shift (Fibonacci
+ * hashing), which takes the integer division out of every search and
+ * every step of a resize.
+ */
+#ifdef SYMTABLE_POW2
+
+/* Bucket count at growth step 0; each later step doubles it */
+static const size_t INITIAL_BUCKET_COUNT = 512;
+
+/* 2^64 divided by the golden ratio, rounded to odd */
+static const unsigned long long FIBONACCI_MULTIPLIER = 0x9e3779b97f4a7c15ULL;
+
+#else
+
+/* Array of prime numbers for bucket counts during hash table expansion.
+ * Past the last entry, bucket counts are computed by SymTable_nextCount.
+ */
 static const size_t primes[] = {509, 1021, 2039, 4093, 8191, 16381, 32749, 65521};
 
 /* Number of elements in the primes array */
 static const size_t numPrimes = sizeof(primes) / sizeof(primes[0]);
 
+#endif
+
+/* Number of old buckets migrated by each put or remove while a resize is
+ * in progress. 0 migrates the whole table as soon as the resize starts;
+ * build with -DSYMTABLE_REHASH_STEP=n to bound the work that any single
+ * put or remove does for a resize. Growth or shrinking that a put or
+ * remove calls for waits until the resize in progress has finished, so
+ * no put or remove migrates more than n buckets. SymTable_reserve and
+ * SymTable_putMany still finish a resize in progress before starting
+ * their own, so one of those calls can migrate every old bucket.
+ */
+#ifndef SYMTABLE_REHASH_STEP
+#define SYMTABLE_REHASH_STEP 0
+#endif
+
+/* Number of keys whose searches SymTable_getMany overlaps */
+enum { GET_MANY_BATCH = 16 };
+
+/* Starts loading the cache line holding pv, where the compiler can */
+#ifdef __GNUC__
+#define PREFETCH(pv) __builtin_prefetch(pv)
+#else
+#define PREFETCH(pv) ((void)(pv))
+#endif
+
 /* A Binding structure represents a single key-value binding in the table.
- * Each node in the bucket's linked list is a Binding.
+ * Each node in the bucket's linked list is a Binding. The key is stored
+ * inline after the node header, so a binding is a single allocation.
  */
 typedef struct Binding {
-    /* Defensive copy of the key string */
-    char *pcKey;
+    /* Full-width hash of the key, before reduction to a bucket index */
+    size_t uHash;
+    /* Length of the key, excluding the terminating null */
+    size_t uKeyLength;
     /* Value associated with the key (client-owned) */
     const void *pvValue;
     /* Next binding in this hash bucket */
     struct Binding *pNext;
+    /* Defensive copy of the key string */
+    char acKey[];
 } Binding;
 
+/* A Lookup is the state of one search in flight in
+ * SymTable_getManyInterleaved, which advances it a step at a time.
+ */
+typedef struct Lookup {
+    /* Index of the key being searched for */
+    size_t uKey;
+    /* Full hash and length of the key */
+    size_t uHash;
+    size_t uKeyLength;
+    /* Bucket being loaded, while iStage is LOOKUP_BUCKET */
+    Binding **ppBucket;
+    /* Binding being loaded, while iStage is LOOKUP_CHAIN */
+    Binding *pCurrent;
+    /* What the next step of the search reads */
+    enum { LOOKUP_IDLE, LOOKUP_BUCKET, LOOKUP_CHAIN } iStage;
+} Lookup;
+
 /* The SymTable structure represents the entire hash table.
  * It maintains the array of buckets, counts, and current size info.
  */
@@ -33,215 +102,862 @@ struct SymTable {
     Binding **ppBuckets;
     /* Current number of buckets */
     size_t uBucketCount;
+    /* Bucket array being migrated into ppBuckets, or NULL if no resize
+     * is in progress */
+    Binding **ppOldBuckets;
+    /* Number of buckets in ppOldBuckets */
+    size_t uOldBucketCount;
+    /* Old buckets below this index have been migrated already */
+    size_t uMigrateIndex;
     /* Number of bindings (total across all buckets) */
     size_t uLength;
-    /* Current index into the primes array */
+    /* Current step of bucket growth; an index into the primes array
+     * while it is below numPrimes, or log2 of the bucket count over
+     * INITIAL_BUCKET_COUNT with -DSYMTABLE_POW2 */
     size_t uPrimeIndex;
+    /* Growth step below which the table does not shrink, as set by
+     * SymTable_newWithCapacity or SymTable_reserve */
+    size_t uMinPrimeIndex;
+    /* Hash function for keys, or NULL for the assignment hash */
+    size_t (*pfHash)(const char *pcKey, size_t uKeyLength,
+                     const void *pvHashExtra);
+    /* Context passed to pfHash */
+    const void *pvHashExtra;
+    /* Key of the hash of a table made by SymTable_newSeeded */
+    unsigned long long aullSeed[2];
+    /* Arena that bindings are allocated from, or NULL to use pfAlloc */
+    Arena_T oArena;
+    /* Allocation functions for the table, its buckets and bindings */
+    void *(*pfAlloc)(size_t uSize, void *pvAllocExtra);
+    void (*pfFree)(void *pvBlock, size_t uSize, void *pvAllocExtra);
+    /* Context passed to pfAlloc and pfFree */
+    void *pvAllocExtra;
+    /* Number of resizes that grew and that shrank the bucket array */
+    size_t uExpansions;
+    size_t uShrinks;
+    /* Latency histograms and search counts, when built with
+     * -DSYMTABLE_TRACE */
+    TRACE_MEMBERS
 };
 
-/* Computes a hash value for pcKey, returning a value between 0 and uBucketCount-1.
- * Uses the hash function specified in the assignment.
- * pcKey must not be NULL.
+/* A SymTableIter structure is a position in the buckets of a table: the
+ * old buckets not yet migrated by a resize in progress, then the current
+ * ones.
  */
-static size_t SymTable_hash(const char *pcKey, size_t uBucketCount) {
+struct SymTableIter {
+    /* Table being iterated over */
+    SymTable_T oSymTable;
+    /* Bucket array being walked, and its number of buckets */
+    Binding **ppBuckets;
+    size_t uBucketCount;
+    /* Index of the next bucket of ppBuckets to walk */
+    size_t uNextBucket;
+    /* Next binding to return, or NULL to move to the next bucket */
+    Binding *pNext;
+};
+
+/* Computes the full-width hash value for pcKey in oSymTable and stores
+ * the length of pcKey in *puKeyLength. The bucket index is this value
+ * modulo the bucket count.
+ * Uses the table's hash function, or else the hash function specified in
+ * the assignment, which measures the key in the same pass.
+ * oSymTable, pcKey and puKeyLength must not be NULL.
+ */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey,
+                            size_t *puKeyLength) {
     const size_t HASH_MULTIPLIER = 65599;
     size_t uHash = 0;
     size_t u;
     
+    assert(oSymTable != NULL);
     assert(pcKey != NULL);
+    assert(puKeyLength != NULL);
+    
+    if (oSymTable->pfHash != NULL) {
+        *puKeyLength = strlen(pcKey);
+        return oSymTable->pfHash(pcKey, *puKeyLength, oSymTable->pvHashExtra);
+    }
     
     /* Compute hash value by multiplying previous value by prime and adding char */
     for (u = 0; pcKey[u] != '\0'; u++)
         uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
     
+    *puKeyLength = u;
+    return uHash;
+}
+
+/* Returns 1 if pBinding, examined by a search of oSymTable, holds the
+ * key pcKey, whose full hash is uHash and whose length is uKeyLength,
+ * or 0 otherwise.
+ * The cached hash and length reject almost every mismatch before any
+ * key bytes are compared.
+ */
+static int SymTable_matches(SymTable_T oSymTable, const Binding *pBinding,
+                            const char *pcKey, size_t uHash,
+                            size_t uKeyLength) {
+    TRACE_PROBE(oSymTable);
+    if (pBinding->uHash != uHash || pBinding->uKeyLength != uKeyLength)
+        return 0;
+    
+    TRACE_KEY_COMPARE(oSymTable);
+    return memcmp(pBinding->acKey, pcKey, uKeyLength) == 0;
+}
+
+#ifdef SYMTABLE_POW2
+
+/* Returns the bucket count that follows uBucketCount, the count at growth
+ * step uPrimeIndex: twice uBucketCount. Returns 0 if the next count would
+ * not fit in a size_t bucket array, or would exceed the 2^32 buckets that
+ * SymTable_indexFor can reach.
+ */
+static size_t SymTable_nextCount(size_t uPrimeIndex, size_t uBucketCount) {
+    (void)uPrimeIndex;
+    
+    if (uBucketCount > ((size_t)-1 / sizeof(Binding *)) / 2 ||
+        (unsigned long long)uBucketCount > 0x80000000ULL)
+        return 0;
+    
+    return uBucketCount * 2;
+}
+
+/* Returns the bucket count that precedes uBucketCount, the count at growth
+ * step uPrimeIndex (which must be positive): half of uBucketCount.
+ */
+static size_t SymTable_prevCount(size_t uPrimeIndex, size_t uBucketCount) {
+    assert(uPrimeIndex > 0);
+    (void)uPrimeIndex;
+    
+    return uBucketCount / 2;
+}
+
+/* Returns the index of the bucket for full hash uHash in an array of
+ * uBucketCount buckets, a power of two no greater than 2^32.
+ * Multiplying by the Fibonacci constant mixes every bit of uHash into
+ * the top bits of the product, and scaling its top 32 bits by
+ * uBucketCount keeps the top log2(uBucketCount) of them. No division is
+ * needed.
+ */
+static size_t SymTable_indexFor(size_t uHash, size_t uBucketCount) {
+    unsigned long long ullMixed;
+    
+    ullMixed = ((unsigned long long)uHash * FIBONACCI_MULTIPLIER) >> 32;
+    return (size_t)((ullMixed * uBucketCount) >> 32);
+}
+
+#else
+
+/* Returns 1 if uCandidate is prime, 0 otherwise.
+ * Trial division is cheap next to the rehash that follows it.
+ */
+static int SymTable_isPrime(size_t uCandidate) {
+    size_t uDivisor;
+    
+    if (uCandidate < 2)
+        return 0;
+    if (uCandidate % 2 == 0)
+        return uCandidate == 2;
+    
+    for (uDivisor = 3; uDivisor <= uCandidate / uDivisor; uDivisor += 2) {
+        if (uCandidate % uDivisor == 0)
+            return 0;
+    }
+    
+    return 1;
+}
+
+/* Returns the bucket count that follows uBucketCount, the count at growth
+ * step uPrimeIndex: the next entry of
+ * primes[] while one exists, then the smallest prime at least twice
+ * uBucketCount. Returns 0 if the next count would not fit in a size_t
+ * bucket array.
+ */
+static size_t SymTable_nextCount(size_t uPrimeIndex, size_t uBucketCount) {
+    size_t uCandidate;
+    
+    if (uPrimeIndex + 1 < numPrimes)
+        return primes[uPrimeIndex + 1];
+    
+    /* Leave room for the doubling and for the array's byte size */
+    if (uBucketCount > ((size_t)-1 / sizeof(Binding *) - 1) / 2)
+        return 0;
+    
+    for (uCandidate = uBucketCount * 2 + 1; !SymTable_isPrime(uCandidate);
+         uCandidate += 2)
+        ;
+    
+    return uCandidate;
+}
+
+/* Returns the bucket count that precedes uBucketCount, the count at growth
+ * step uPrimeIndex (which must be positive): the previous entry of
+ * primes[] while uPrimeIndex is within it, otherwise the largest prime
+ * at most half of uBucketCount.
+ */
+static size_t SymTable_prevCount(size_t uPrimeIndex, size_t uBucketCount) {
+    size_t uCandidate;
+    
+    assert(uPrimeIndex > 0);
+    
+    if (uPrimeIndex - 1 < numPrimes)
+        return primes[uPrimeIndex - 1];
+    
+    for (uCandidate = (uBucketCount / 2) | 1; !SymTable_isPrime(uCandidate);
+         uCandidate -= 2)
+        ;
+    
+    return uCandidate;
+}
+
+/* Returns the index of the bucket for full hash uHash in an array of
+ * uBucketCount buckets */
+static size_t SymTable_indexFor(size_t uHash, size_t uBucketCount) {
     return uHash % uBucketCount;
 }
 
-/* Expands the hash table by increasing bucket count and rehashing all bindings.
- * Returns 1 if successful, 0 if memory allocation fails.
- * If already at maximum bucket count, returns 1 without expansion.
+#endif
+
+/* Allocates uSize bytes with malloc; the allocator of tables created
+ * without one of their own */
+static void *SymTable_defaultAlloc(size_t uSize, void *pvAllocExtra) {
+    (void)pvAllocExtra;
+    return malloc(uSize);
+}
+
+/* Frees pvBlock with free; the counterpart of SymTable_defaultAlloc */
+static void SymTable_defaultFree(void *pvBlock, size_t uSize,
+                                 void *pvAllocExtra) {
+    (void)uSize;
+    (void)pvAllocExtra;
+    free(pvBlock);
+}
+
+/* Allocates an array of uBucketCount empty buckets with the allocator
+ * of oSymTable.
+ * Returns NULL if insufficient memory is available.
  * oSymTable must not be NULL.
  */
-static int SymTable_expandTable(SymTable_T oSymTable) {
-    size_t uNewPrimeIndex;
-    size_t uNewBucketCount;
+static Binding **SymTable_allocBucketArray(SymTable_T oSymTable,
+                                           size_t uBucketCount) {
+    Binding **ppBuckets;
     size_t i;
-    size_t uNewIndex;
-    Binding **ppNewBuckets;
-    Binding *pCurrent;
-    Binding *pNext;
     
     assert(oSymTable != NULL);
     
-    /* Check if already at maximum bucket count */
-    if (oSymTable->uPrimeIndex + 1 >= numPrimes)
-        return 1;
+    if (uBucketCount > (size_t)-1 / sizeof(Binding *))
+        return NULL;
     
-    /* Get next prime bucket count */
-    uNewPrimeIndex = oSymTable->uPrimeIndex + 1;
-    uNewBucketCount = primes[uNewPrimeIndex];
+    /* calloc gets large arrays as fresh zeroed pages instead of clearing
+     * them here, which would stall a resize in proportion to the new
+     * bucket count. Other allocators give no such guarantee. */
+    if (oSymTable->pfAlloc == SymTable_defaultAlloc)
+        return calloc(uBucketCount, sizeof(Binding *));
     
-    /* Allocate new array of bucket pointers */
-    ppNewBuckets = malloc(uNewBucketCount * sizeof(Binding *));
-    if (ppNewBuckets == NULL)
-        return 0;
+    ppBuckets = oSymTable->pfAlloc(uBucketCount * sizeof(Binding *),
+                                   oSymTable->pvAllocExtra);
+    if (ppBuckets == NULL)
+        return NULL;
+    for (i = 0; i < uBucketCount; i++)
+        ppBuckets[i] = NULL;
     
-    /* Initialize all new buckets to empty */
-    for (i = 0; i < uNewBucketCount; i++)
-        ppNewBuckets[i] = NULL;
+    return ppBuckets;
+}
+
+/* Frees ppBuckets, an array of uBucketCount buckets allocated by
+ * SymTable_allocBucketArray, but not the bindings in it.
+ * oSymTable must not be NULL.
+ */
+static void SymTable_freeBucketArray(SymTable_T oSymTable,
+                                     Binding **ppBuckets,
+                                     size_t uBucketCount) {
+    assert(oSymTable != NULL);
     
-    /* Rehash each binding into the new bucket array */
-    for (i = 0; i < oSymTable->uBucketCount; i++) {
-        for (pCurrent = oSymTable->ppBuckets[i]; pCurrent != NULL; pCurrent = pNext) {
+    if (ppBuckets != NULL)
+        oSymTable->pfFree(ppBuckets, uBucketCount * sizeof(Binding *),
+                          oSymTable->pvAllocExtra);
+}
+
+/* Allocates a binding of uSize bytes, key included, from the arena of
+ * oSymTable or else with its allocator.
+ * Returns NULL if insufficient memory is available.
+ * oSymTable must not be NULL.
+ */
+static Binding *SymTable_allocBinding(SymTable_T oSymTable, size_t uSize) {
+    assert(oSymTable != NULL);
+    
+    if (oSymTable->oArena != NULL)
+        return Arena_alloc(oSymTable->oArena, uSize);
+    return oSymTable->pfAlloc(uSize, oSymTable->pvAllocExtra);
+}
+
+/* Frees pBinding, which was allocated by SymTable_allocBinding. An arena
+ * keeps the binding on a free list for reuse.
+ * oSymTable and pBinding must not be NULL.
+ */
+static void SymTable_freeBinding(SymTable_T oSymTable, Binding *pBinding) {
+    size_t uSize;
+    
+    assert(oSymTable != NULL);
+    assert(pBinding != NULL);
+    
+    uSize = sizeof(Binding) + pBinding->uKeyLength + 1;
+    if (oSymTable->oArena != NULL)
+        Arena_release(oSymTable->oArena, pBinding, uSize);
+    else
+        oSymTable->pfFree(pBinding, uSize, oSymTable->pvAllocExtra);
+}
+
+/* Returns the first growth step whose bucket count is at least
+ * uCapacity, or the last step if none is, and stores that step's bucket
+ * count in *puBucketCount.
+ * puBucketCount must not be NULL.
+ */
+static size_t SymTable_stepFor(size_t uCapacity, size_t *puBucketCount) {
+    size_t uPrimeIndex = 0;
+#ifdef SYMTABLE_POW2
+    size_t uBucketCount = INITIAL_BUCKET_COUNT;
+#else
+    size_t uBucketCount = primes[0];
+#endif
+    size_t uNextCount;
+    
+    assert(puBucketCount != NULL);
+    
+    while (uBucketCount < uCapacity) {
+        uNextCount = SymTable_nextCount(uPrimeIndex, uBucketCount);
+        if (uNextCount == 0)
+            break;
+        uPrimeIndex++;
+        uBucketCount = uNextCount;
+    }
+    
+    *puBucketCount = uBucketCount;
+    return uPrimeIndex;
+}
+
+/* Returns the address of the bucket whose chain holds, or would hold,
+ * a key with full hash uHash. While a resize is in progress, a key whose
+ * old bucket has not been migrated yet is still in ppOldBuckets.
+ * oSymTable must not be NULL.
+ */
+static Binding **SymTable_bucketFor(SymTable_T oSymTable, size_t uHash) {
+    size_t uOldIndex;
+    
+    assert(oSymTable != NULL);
+    
+    if (oSymTable->ppOldBuckets != NULL) {
+        uOldIndex = SymTable_indexFor(uHash, oSymTable->uOldBucketCount);
+        if (uOldIndex >= oSymTable->uMigrateIndex)
+            return &oSymTable->ppOldBuckets[uOldIndex];
+    }
+    
+    return &oSymTable->ppBuckets[SymTable_indexFor(uHash,
+                                                    oSymTable->uBucketCount)];
+}
+
+/* Migrates up to uSteps old buckets into ppBuckets, redistributing their
+ * bindings by cached hash, and frees the old bucket array once every
+ * bucket has been migrated. Does nothing if no resize is in progress.
+ * oSymTable must not be NULL.
+ */
+static void SymTable_migrate(SymTable_T oSymTable, size_t uSteps) {
+    size_t uNewIndex;
+    Binding *pCurrent;
+    Binding *pNext;
+    
+    assert(oSymTable != NULL);
+    
+    for (; oSymTable->ppOldBuckets != NULL && uSteps > 0; uSteps--) {
+        pCurrent = oSymTable->ppOldBuckets[oSymTable->uMigrateIndex];
+        for (; pCurrent != NULL; pCurrent = pNext) {
             /* Save next binding before changing current's next pointer */
             pNext = pCurrent->pNext;
             
-            /* Compute new hash index for this key */
-            uNewIndex = SymTable_hash(pCurrent->pcKey, uNewBucketCount);
+            /* Reduce the cached hash; no key bytes are touched */
+            uNewIndex = SymTable_indexFor(pCurrent->uHash,
+                                          oSymTable->uBucketCount);
             
             /* Insert at head of appropriate new bucket */
-            pCurrent->pNext = ppNewBuckets[uNewIndex];
-            ppNewBuckets[uNewIndex] = pCurrent;
+            pCurrent->pNext = oSymTable->ppBuckets[uNewIndex];
+            oSymTable->ppBuckets[uNewIndex] = pCurrent;
+        }
+        
+        /* Free the old bucket array after its last bucket */
+        oSymTable->uMigrateIndex++;
+        if (oSymTable->uMigrateIndex == oSymTable->uOldBucketCount) {
+            SymTable_freeBucketArray(oSymTable, oSymTable->ppOldBuckets,
+                                     oSymTable->uOldBucketCount);
+            oSymTable->ppOldBuckets = NULL;
         }
     }
+}
+
+/* Starts resizing oSymTable to uNewBucketCount buckets at growth step
+ * uNewPrimeIndex. The current bucket array becomes the old array, to be
+ * emptied by SymTable_migrate; with SYMTABLE_REHASH_STEP 0 that happens
+ * before returning. A resize already in progress is finished first, all
+ * at once; only SymTable_reserve and SymTable_putMany can call this
+ * while one is, since puts and removes wait for it to finish.
+ * Returns 1 if successful, 0 if memory allocation fails.
+ * oSymTable must not be NULL.
+ */
+static int SymTable_resize(SymTable_T oSymTable, size_t uNewPrimeIndex,
+                           size_t uNewBucketCount) {
+    Binding **ppNewBuckets;
+    
+    assert(oSymTable != NULL);
+    
+    /* Allocate new array of empty buckets */
+    ppNewBuckets = SymTable_allocBucketArray(oSymTable, uNewBucketCount);
+    if (ppNewBuckets == NULL)
+        return 0;
+    
+    /* Only one old bucket array can be live at a time */
+    if (oSymTable->ppOldBuckets != NULL)
+        SymTable_migrate(oSymTable, oSymTable->uOldBucketCount);
     
-    /* Free old bucket array */
-    free(oSymTable->ppBuckets);
+    /* The current buckets become the old buckets to migrate from */
+    oSymTable->ppOldBuckets = oSymTable->ppBuckets;
+    oSymTable->uOldBucketCount = oSymTable->uBucketCount;
+    oSymTable->uMigrateIndex = 0;
+    
+    if (uNewBucketCount > oSymTable->uBucketCount)
+        oSymTable->uExpansions++;
+    else
+        oSymTable->uShrinks++;
     
     /* Update symtable with new bucket array and counts */
     oSymTable->ppBuckets = ppNewBuckets;
     oSymTable->uBucketCount = uNewBucketCount;
     oSymTable->uPrimeIndex = uNewPrimeIndex;
     
+    if (SYMTABLE_REHASH_STEP == 0)
+        SymTable_migrate(oSymTable, oSymTable->uOldBucketCount);
+    
     return 1;
 }
 
-SymTable_T SymTable_new(void) {
+/* Expands the hash table to the next bucket count in the growth
+ * sequence, migrating bindings by their cached hashes.
+ * Returns 1 if successful, 0 if memory allocation fails.
+ * If the bucket count cannot grow any further, returns 1 without expansion.
+ * oSymTable must not be NULL.
+ */
+static int SymTable_expandTable(SymTable_T oSymTable) {
+    size_t uNewBucketCount;
+    
+    assert(oSymTable != NULL);
+    
+    /* Get next bucket count */
+    uNewBucketCount = SymTable_nextCount(oSymTable->uPrimeIndex,
+                                         oSymTable->uBucketCount);
+    
+    /* Check if already at maximum bucket count */
+    if (uNewBucketCount == 0)
+        return 1;
+    
+    return SymTable_resize(oSymTable, oSymTable->uPrimeIndex + 1,
+                           uNewBucketCount);
+}
+
+/* Shrinks the hash table to the previous bucket count in the growth
+ * sequence, so that memory and the cost of SymTable_map and SymTable_free
+ * follow the live bindings rather than the historical peak.
+ * Returns 1 if successful, 0 if memory allocation fails.
+ * oSymTable must not be NULL and must be above its minimum growth step.
+ */
+static int SymTable_shrinkTable(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    assert(oSymTable->uPrimeIndex > oSymTable->uMinPrimeIndex);
+    
+    return SymTable_resize(oSymTable, oSymTable->uPrimeIndex - 1,
+                           SymTable_prevCount(oSymTable->uPrimeIndex,
+                                              oSymTable->uBucketCount));
+}
+
+/* Creates and returns a new empty table sized for uCapacity bindings,
+ * whose memory comes from pfAlloc and goes back through pfFree.
+ * Returns NULL if insufficient memory is available.
+ * pfAlloc and pfFree must not be NULL.
+ */
+static SymTable_T SymTable_create(
+    size_t uCapacity,
+    void *(*pfAlloc)(size_t uSize, void *pvAllocExtra),
+    void (*pfFree)(void *pvBlock, size_t uSize, void *pvAllocExtra),
+    void *pvAllocExtra) {
     SymTable_T oSymTable;
-    size_t i;
+    
+    assert(pfAlloc != NULL);
+    assert(pfFree != NULL);
     
     /* Allocate memory for the SymTable structure */
-    oSymTable = malloc(sizeof(struct SymTable));
+    oSymTable = pfAlloc(sizeof(struct SymTable), pvAllocExtra);
     if (oSymTable == NULL)
         return NULL;
     
-    /* Start with the first prime bucket count */
-    oSymTable->uPrimeIndex = 0;
-    oSymTable->uBucketCount = primes[oSymTable->uPrimeIndex];
+    oSymTable->pfAlloc = pfAlloc;
+    oSymTable->pfFree = pfFree;
+    oSymTable->pvAllocExtra = pvAllocExtra;
+    
+    /* Start with the first bucket count that fits uCapacity */
+    oSymTable->uPrimeIndex = SymTable_stepFor(uCapacity, &oSymTable->uBucketCount);
+    oSymTable->uMinPrimeIndex = oSymTable->uPrimeIndex;
     oSymTable->uLength = 0;
+    oSymTable->oArena = NULL;
+    oSymTable->pfHash = NULL;
+    oSymTable->pvHashExtra = NULL;
+    oSymTable->ppOldBuckets = NULL;
+    oSymTable->uOldBucketCount = 0;
+    oSymTable->uMigrateIndex = 0;
+    oSymTable->uExpansions = 0;
+    oSymTable->uShrinks = 0;
+    TRACE_INIT(oSymTable);
     
-    /* Allocate the initial bucket array */
-    oSymTable->ppBuckets = malloc(oSymTable->uBucketCount * sizeof(Binding *));
+    /* Allocate the initial array of empty buckets */
+    oSymTable->ppBuckets = SymTable_allocBucketArray(oSymTable,
+                                                     oSymTable->uBucketCount);
     if (oSymTable->ppBuckets == NULL) {
-        free(oSymTable);
+        pfFree(oSymTable, sizeof(struct SymTable), pvAllocExtra);
         return NULL;
     }
     
-    /* Initialize all buckets to empty */
-    for (i = 0; i < oSymTable->uBucketCount; i++)
-        oSymTable->ppBuckets[i] = NULL;
+    return oSymTable;
+}
+
+SymTable_T SymTable_new(void) {
+    return SymTable_newWithCapacity(0);
+}
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+    return SymTable_create(uCapacity, SymTable_defaultAlloc,
+                           SymTable_defaultFree, NULL);
+}
+
+SymTable_T SymTable_newWithAllocator(
+    void *(*pfAlloc)(size_t uSize, void *pvAllocExtra),
+    void (*pfFree)(void *pvBlock, size_t uSize, void *pvAllocExtra),
+    void *pvAllocExtra) {
+    return SymTable_create(0, pfAlloc, pfFree, pvAllocExtra);
+}
+
+SymTable_T SymTable_newWithHash(
+    size_t (*pfHash)(const char *pcKey, size_t uKeyLength,
+                     const void *pvHashExtra),
+    const void *pvHashExtra) {
+    SymTable_T oSymTable;
+    
+    assert(pfHash != NULL);
     
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+        return NULL;
+    
+    oSymTable->pfHash = pfHash;
+    oSymTable->pvHashExtra = pvHashExtra;
     return oSymTable;
 }
 
-void SymTable_free(SymTable_T oSymTable) {
+SymTable_T SymTable_newSeeded(void) {
+    SymTable_T oSymTable;
+    
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+        return NULL;
+    
+    /* The hash key lives in the table and is freed with it */
+    HashFn_randomSeed(oSymTable->aullSeed);
+    oSymTable->pfHash = SymTable_hashSiphash13;
+    oSymTable->pvHashExtra = oSymTable->aullSeed;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newArena(void) {
+    SymTable_T oSymTable;
+    
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+        return NULL;
+    
+    /* Bindings come from the arena from the first put on */
+    oSymTable->oArena = Arena_new();
+    if (oSymTable->oArena == NULL) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    
+    return oSymTable;
+}
+
+/* Frees every binding in buckets uFirst through uCount-1 of ppBuckets,
+ * a bucket array of oSymTable */
+static void SymTable_freeBuckets(SymTable_T oSymTable, Binding **ppBuckets,
+                                 size_t uFirst, size_t uCount) {
     size_t i;
     Binding *pCurrent;
     Binding *pTemp;
     
-    assert(oSymTable != NULL);
-    
     /* Process each bucket */
-    for (i = 0; i < oSymTable->uBucketCount; i++) {
+    for (i = uFirst; i < uCount; i++) {
         /* Free all bindings in this bucket */
-        for (pCurrent = oSymTable->ppBuckets[i]; pCurrent != NULL; pCurrent = pTemp) {
+        for (pCurrent = ppBuckets[i]; pCurrent != NULL; pCurrent = pTemp) {
             /* Save next binding before freeing current */
             pTemp = pCurrent->pNext;
             
-            /* Free the key string */
-            free(pCurrent->pcKey);
-            
-            /* Free the binding structure */
-            free(pCurrent);
+            /* Free the binding structure and its key */
+            SymTable_freeBinding(oSymTable, pCurrent);
         }
     }
+}
+
+void SymTable_free(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
     
-    /* Free the bucket array */
-    free(oSymTable->ppBuckets);
+    /* An arena frees all bindings at once, slab by slab */
+    if (oSymTable->oArena != NULL)
+        Arena_free(oSymTable->oArena);
+    else {
+        /* Free the bindings of any old buckets not yet migrated */
+        if (oSymTable->ppOldBuckets != NULL)
+            SymTable_freeBuckets(oSymTable, oSymTable->ppOldBuckets,
+                                 oSymTable->uMigrateIndex,
+                                 oSymTable->uOldBucketCount);
+        
+        /* Free the bindings */
+        SymTable_freeBuckets(oSymTable, oSymTable->ppBuckets, 0,
+                             oSymTable->uBucketCount);
+    }
+    
+    /* Free the bucket arrays */
+    SymTable_freeBucketArray(oSymTable, oSymTable->ppOldBuckets,
+                             oSymTable->uOldBucketCount);
+    SymTable_freeBucketArray(oSymTable, oSymTable->ppBuckets,
+                             oSymTable->uBucketCount);
     
     /* Free the SymTable structure */
-    free(oSymTable);
+    oSymTable->pfFree(oSymTable, sizeof(struct SymTable),
+                      oSymTable->pvAllocExtra);
 }
 
-size_t SymTable_getLength(SymTable_T oSymTable) {
-    assert(oSymTable != NULL);
+/* Returns the binding in the chain starting at pFirst that holds pcKey,
+ * whose full hash is uHash and whose length is uKeyLength, or NULL if
+ * there is none.
+ * oSymTable and pcKey must not be NULL.
+ */
+static Binding *SymTable_findIn(SymTable_T oSymTable, Binding *pFirst,
+                                const char *pcKey, size_t uHash,
+                                size_t uKeyLength) {
+    Binding *pCurrent;
     
-    return oSymTable->uLength;
+    for (pCurrent = pFirst; pCurrent != NULL; pCurrent = pCurrent->pNext) {
+        if (SymTable_matches(oSymTable, pCurrent, pcKey, uHash, uKeyLength))
+            return pCurrent;
+    }
+    
+    return NULL;
 }
 
-int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
-    size_t index;
-    Binding *pCurrent;
+/* Adds a binding of pcKey, whose full hash is uHash and whose length is
+ * uKeyLength, to pvValue at the head of *ppBucket, the bucket that
+ * SymTable_bucketFor gives for uHash. pcKey must not be in the table
+ * already. Then advances any resize in progress and expands the table
+ * if it is too full, either of which may move the binding to another
+ * bucket, but not to another address.
+ * Returns the new binding, or NULL if insufficient memory is available.
+ * oSymTable, ppBucket and pcKey must not be NULL.
+ */
+static Binding *SymTable_insert(SymTable_T oSymTable, Binding **ppBucket,
+                                const char *pcKey, size_t uHash,
+                                size_t uKeyLength, const void *pvValue) {
     Binding *pNew;
     
     assert(oSymTable != NULL);
+    assert(ppBucket != NULL);
     assert(pcKey != NULL);
     
-    /* Compute hash bucket index for this key */
-    index = SymTable_hash(pcKey, oSymTable->uBucketCount);
-    
-    /* Check if key already exists in this bucket */
-    for (pCurrent = oSymTable->ppBuckets[index]; pCurrent != NULL; pCurrent = pCurrent->pNext) {
-        if (strcmp(pCurrent->pcKey, pcKey) == 0)
-            return 0;
-    }
-    
-    /* Allocate memory for new binding */
-    pNew = malloc(sizeof(Binding));
+    /* Allocate memory for new binding with room for the key */
+    pNew = SymTable_allocBinding(oSymTable, sizeof(Binding) + uKeyLength + 1);
     if (pNew == NULL)
-        return 0;
-    
-    /* Allocate memory for defensive copy of key */
-    pNew->pcKey = malloc(strlen(pcKey) + 1);
-    if (pNew->pcKey == NULL) {
-        free(pNew);
-        return 0;
-    }
+        return NULL;
     
     /* Create defensive copy of the key */
-    strcpy(pNew->pcKey, pcKey);
+    memcpy(pNew->acKey, pcKey, uKeyLength + 1);
+    pNew->uHash = uHash;
+    pNew->uKeyLength = uKeyLength;
     
     /* Store the value pointer (no defensive copy) */
     pNew->pvValue = pvValue;
     
     /* Insert at the head of the bucket's list */
-    pNew->pNext = oSymTable->ppBuckets[index];
-    oSymTable->ppBuckets[index] = pNew;
+    pNew->pNext = *ppBucket;
+    *ppBucket = pNew;
     
     /* Increment the binding count */
     oSymTable->uLength++;
     
-    /* Check if expansion is needed (bindings > buckets) */
-    if (oSymTable->uLength > oSymTable->uBucketCount)
+    /* Advance any resize in progress */
+    SymTable_migrate(oSymTable, SYMTABLE_REHASH_STEP);
+    
+    /* Check if expansion is needed (bindings > buckets), once any resize
+     * in progress is done */
+    if (oSymTable->ppOldBuckets == NULL &&
+        oSymTable->uLength > oSymTable->uBucketCount)
         SymTable_expandTable(oSymTable);
     
+    return pNew;
+}
+
+/* Starts the search in psLookup for apcKeys[uKey] in oSymTable: hashes
+ * the key and prefetches its bucket, which the next step reads.
+ * oSymTable, psLookup and apcKeys[uKey] must not be NULL.
+ */
+static void SymTable_startLookup(SymTable_T oSymTable, Lookup *psLookup,
+                                 const char *apcKeys[], size_t uKey) {
+    assert(oSymTable != NULL);
+    assert(psLookup != NULL);
+    assert(apcKeys[uKey] != NULL);
+    
+    psLookup->uKey = uKey;
+    psLookup->uHash = SymTable_hash(oSymTable, apcKeys[uKey],
+                                    &psLookup->uKeyLength);
+    psLookup->ppBucket = SymTable_bucketFor(oSymTable, psLookup->uHash);
+    PREFETCH(psLookup->ppBucket);
+    psLookup->iStage = LOOKUP_BUCKET;
+}
+
+/* Advances the search in psLookup by one load: the bucket, or the next
+ * binding of the chain, each of which was prefetched by the step before.
+ * Prefetches what the following step reads.
+ * Returns 1 if the search has finished, having stored its result in
+ * apvValues and counted a hit in *puFound, or 0 otherwise.
+ * oSymTable, psLookup, apcKeys, apvValues and puFound must not be NULL.
+ */
+static int SymTable_stepLookup(SymTable_T oSymTable, Lookup *psLookup,
+                               const char *apcKeys[], void *apvValues[],
+                               size_t *puFound) {
+    assert(oSymTable != NULL);
+    assert(psLookup != NULL);
+    assert(puFound != NULL);
+    
+    if (psLookup->iStage == LOOKUP_BUCKET) {
+        psLookup->pCurrent = *psLookup->ppBucket;
+        psLookup->iStage = LOOKUP_CHAIN;
+    }
+    else if (SymTable_matches(oSymTable, psLookup->pCurrent,
+                              apcKeys[psLookup->uKey], psLookup->uHash,
+                              psLookup->uKeyLength)) {
+        apvValues[psLookup->uKey] = (void *)psLookup->pCurrent->pvValue;
+        (*puFound)++;
+        return 1;
+    }
+    else
+        psLookup->pCurrent = psLookup->pCurrent->pNext;
+    
+    if (psLookup->pCurrent == NULL) {
+        apvValues[psLookup->uKey] = NULL;
+        return 1;
+    }
+    
+    PREFETCH(psLookup->pCurrent);
+    return 0;
+}
+
+/* A MapJob structure holds the arguments of SymTable_mapParallel for
+ * each of its threads */
+typedef struct MapJob {
+    SymTable_T oSymTable;
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+    void *pvExtra;
+} MapJob;
+
+/* Applies the function of pvMapJob, a MapJob, to every binding in
+ * buckets uStart to uEnd - 1 of its table, numbering the old buckets
+ * not yet migrated by a resize in progress before the current ones.
+ */
+static void SymTable_mapRange(size_t uStart, size_t uEnd, void *pvMapJob) {
+    const MapJob *psJob = pvMapJob;
+    SymTable_T oSymTable = psJob->oSymTable;
+    size_t uOldRemaining = 0;
+    Binding *pCurrent;
+    size_t i;
+    
+    if (oSymTable->ppOldBuckets != NULL)
+        uOldRemaining = oSymTable->uOldBucketCount - oSymTable->uMigrateIndex;
+    
+    for (i = uStart; i < uEnd; i++) {
+        if (i < uOldRemaining)
+            pCurrent = oSymTable->ppOldBuckets[oSymTable->uMigrateIndex + i];
+        else
+            pCurrent = oSymTable->ppBuckets[i - uOldRemaining];
+        for (; pCurrent != NULL; pCurrent = pCurrent->pNext)
+            psJob->pfApply(pCurrent->acKey, (void *)pCurrent->pvValue,
+                           psJob->pvExtra);
+    }
+}
+
+/* The operations of symtable.h, which the public functions below time
+ * when built with -DSYMTABLE_TRACE */
+
+static int SymTable_doReserve(SymTable_T oSymTable, size_t uCapacity) {
+    size_t uPrimeIndex;
+    size_t uBucketCount;
+    
+    assert(oSymTable != NULL);
+    
+    /* Grow straight to the final bucket count, skipping the steps between */
+    uPrimeIndex = SymTable_stepFor(uCapacity, &uBucketCount);
+    if (uBucketCount > oSymTable->uBucketCount) {
+        if (!SymTable_resize(oSymTable, uPrimeIndex, uBucketCount))
+            return 0;
+    }
+    
+    if (uPrimeIndex > oSymTable->uMinPrimeIndex)
+        oSymTable->uMinPrimeIndex = uPrimeIndex;
+    
     return 1;
 }
 
-void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
-    size_t index;
+static size_t SymTable_doGetLength(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    
+    return oSymTable->uLength;
+}
+
+static int SymTable_doPut(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    Binding **ppBucket;
+    size_t uHash;
+    size_t uKeyLength;
+    
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    
+    /* Find the bucket for this key */
+    uHash = SymTable_hash(oSymTable, pcKey, &uKeyLength);
+    ppBucket = SymTable_bucketFor(oSymTable, uHash);
+    
+    /* Check if key already exists in this bucket */
+    if (SymTable_findIn(oSymTable, *ppBucket, pcKey, uHash, uKeyLength) != NULL)
+        return 0;
+    
+    return SymTable_insert(oSymTable, ppBucket, pcKey, uHash, uKeyLength,
+                           pvValue) != NULL;
+}
+
+static void *SymTable_doReplace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    Binding **ppBucket;
+    size_t uHash;
+    size_t uKeyLength;
     Binding *pCurrent;
     const void *pvOld;
     
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
     
-    /* Compute hash bucket index for this key */
-    index = SymTable_hash(pcKey, oSymTable->uBucketCount);
+    /* Find the bucket for this key */
+    uHash = SymTable_hash(oSymTable, pcKey, &uKeyLength);
+    ppBucket = SymTable_bucketFor(oSymTable, uHash);
     
     /* Search for the key in this bucket */
-    for (pCurrent = oSymTable->ppBuckets[index]; pCurrent != NULL; pCurrent = pCurrent->pNext) {
-        if (strcmp(pCurrent->pcKey, pcKey) == 0) {
+    for (pCurrent = *ppBucket; pCurrent != NULL; pCurrent = pCurrent->pNext) {
+        if (SymTable_matches(oSymTable, pCurrent, pcKey, uHash, uKeyLength)) {
             /* Key found, save the old value */
             pvOld = pCurrent->pvValue;
             
@@ -255,46 +971,54 @@ void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvVa
     return NULL;
 }
 
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
-    size_t index;
+static int SymTable_doContains(SymTable_T oSymTable, const char *pcKey) {
+    Binding **ppBucket;
+    size_t uHash;
+    size_t uKeyLength;
     Binding *pCurrent;
     
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
     
-    /* Compute hash bucket index for this key */
-    index = SymTable_hash(pcKey, oSymTable->uBucketCount);
+    /* Find the bucket for this key */
+    uHash = SymTable_hash(oSymTable, pcKey, &uKeyLength);
+    ppBucket = SymTable_bucketFor(oSymTable, uHash);
     
     /* Search for the key in this bucket */
-    for (pCurrent = oSymTable->ppBuckets[index]; pCurrent != NULL; pCurrent = pCurrent->pNext) {
-        if (strcmp(pCurrent->pcKey, pcKey) == 0)
+    for (pCurrent = *ppBucket; pCurrent != NULL; pCurrent = pCurrent->pNext) {
+        if (SymTable_matches(oSymTable, pCurrent, pcKey, uHash, uKeyLength))
             return 1;
     }
     
     return 0;
 }
 
-void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
-    size_t index;
+static void *SymTable_doGet(SymTable_T oSymTable, const char *pcKey) {
+    Binding **ppBucket;
+    size_t uHash;
+    size_t uKeyLength;
     Binding *pCurrent;
     
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
     
-    /* Compute hash bucket index for this key */
-    index = SymTable_hash(pcKey, oSymTable->uBucketCount);
+    /* Find the bucket for this key */
+    uHash = SymTable_hash(oSymTable, pcKey, &uKeyLength);
+    ppBucket = SymTable_bucketFor(oSymTable, uHash);
     
     /* Search for the key in this bucket */
-    for (pCurrent = oSymTable->ppBuckets[index]; pCurrent != NULL; pCurrent = pCurrent->pNext) {
-        if (strcmp(pCurrent->pcKey, pcKey) == 0)
+    for (pCurrent = *ppBucket; pCurrent != NULL; pCurrent = pCurrent->pNext) {
+        if (SymTable_matches(oSymTable, pCurrent, pcKey, uHash, uKeyLength))
             return (void *)pCurrent->pvValue;
     }
     
     return NULL;
 }
 
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
-    size_t index;
+static void *SymTable_doRemove(SymTable_T oSymTable, const char *pcKey) {
+    Binding **ppBucket;
+    size_t uHash;
+    size_t uKeyLength;
     Binding *pCurrent;
     Binding *pPrev = NULL;
     const void *pvValue;
@@ -302,32 +1026,43 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
     
-    /* Compute hash bucket index for this key */
-    index = SymTable_hash(pcKey, oSymTable->uBucketCount);
+    /* Find the bucket for this key */
+    uHash = SymTable_hash(oSymTable, pcKey, &uKeyLength);
+    ppBucket = SymTable_bucketFor(oSymTable, uHash);
     
     /* Search for the key in this bucket */
-    for (pCurrent = oSymTable->ppBuckets[index]; pCurrent != NULL; pCurrent = pCurrent->pNext) {
-        if (strcmp(pCurrent->pcKey, pcKey) == 0) {
+    for (pCurrent = *ppBucket; pCurrent != NULL; pCurrent = pCurrent->pNext) {
+        if (SymTable_matches(oSymTable, pCurrent, pcKey, uHash, uKeyLength)) {
             /* Key found, remove the binding */
             
             /* Handle case where binding is at the head of bucket */
             if (pPrev == NULL)
-                oSymTable->ppBuckets[index] = pCurrent->pNext;
+                *ppBucket = pCurrent->pNext;
             else
                 pPrev->pNext = pCurrent->pNext;
             
             /* Save the value to return */
             pvValue = pCurrent->pvValue;
             
-            /* Free the key string */
-            free(pCurrent->pcKey);
-            
-            /* Free the binding structure */
-            free(pCurrent);
+            /* Free the binding structure and its key */
+            SymTable_freeBinding(oSymTable, pCurrent);
             
             /* Decrement the binding count */
             oSymTable->uLength--;
             
+            /* Advance any resize in progress */
+            SymTable_migrate(oSymTable, SYMTABLE_REHASH_STEP);
+            
+            /* Check if shrinking is needed (bindings < buckets / 4).
+             * Growth happens above one binding per bucket and a shrink
+             * leaves about one binding per two buckets, so neither
+             * resize can be undone by just a few puts or removes. As
+             * with growth, wait for any resize in progress to finish. */
+            if (oSymTable->ppOldBuckets == NULL &&
+                oSymTable->uPrimeIndex > oSymTable->uMinPrimeIndex &&
+                oSymTable->uLength < oSymTable->uBucketCount / 4)
+                SymTable_shrinkTable(oSymTable);
+            
             return (void *)pvValue;
         }
         
@@ -338,18 +1073,612 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
     return NULL;
 }
 
-void SymTable_map(SymTable_T oSymTable,
-                  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
-                  const void *pvExtra) {
+static void SymTable_doMap(SymTable_T oSymTable,
+                           void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                           const void *pvExtra) {
     size_t i;
     Binding *pCurrent;
     
     assert(oSymTable != NULL);
     assert(pfApply != NULL);
     
+    /* Process each old bucket not yet migrated */
+    if (oSymTable->ppOldBuckets != NULL) {
+        for (i = oSymTable->uMigrateIndex; i < oSymTable->uOldBucketCount; i++) {
+            for (pCurrent = oSymTable->ppOldBuckets[i]; pCurrent != NULL; pCurrent = pCurrent->pNext)
+                pfApply(pCurrent->acKey, (void *)pCurrent->pvValue, (void *)pvExtra);
+        }
+    }
+    
     /* Process each bucket */
     for (i = 0; i < oSymTable->uBucketCount; i++) {
         for (pCurrent = oSymTable->ppBuckets[i]; pCurrent != NULL; pCurrent = pCurrent->pNext)
-            pfApply(pCurrent->pcKey, (void *)pCurrent->pvValue, (void *)pvExtra);
+            pfApply(pCurrent->acKey, (void *)pCurrent->pvValue, (void *)pvExtra);
     }
 }
+
+static int SymTable_doUpsert(SymTable_T oSymTable, const char *pcKey,
+                             const void *pvValue, void **ppvOldValue) {
+    Binding **ppBucket;
+    size_t uHash;
+    size_t uKeyLength;
+    Binding *pBinding;
+    
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    
+    /* One hash and one walk of the chain, whatever the outcome */
+    uHash = SymTable_hash(oSymTable, pcKey, &uKeyLength);
+    ppBucket = SymTable_bucketFor(oSymTable, uHash);
+    pBinding = SymTable_findIn(oSymTable, *ppBucket, pcKey, uHash, uKeyLength);
+    
+    if (pBinding != NULL) {
+        if (ppvOldValue != NULL)
+            *ppvOldValue = (void *)pBinding->pvValue;
+        pBinding->pvValue = pvValue;
+        return 0;
+    }
+    
+    if (SymTable_insert(oSymTable, ppBucket, pcKey, uHash, uKeyLength,
+                        pvValue) == NULL)
+        return -1;
+    return 1;
+}
+
+static void *SymTable_doGetOrPut(SymTable_T oSymTable, const char *pcKey,
+                                 const void *pvValue, int *piAdded) {
+    Binding **ppBucket;
+    size_t uHash;
+    size_t uKeyLength;
+    Binding *pBinding;
+    int iAdded = 0;
+    
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    
+    uHash = SymTable_hash(oSymTable, pcKey, &uKeyLength);
+    ppBucket = SymTable_bucketFor(oSymTable, uHash);
+    pBinding = SymTable_findIn(oSymTable, *ppBucket, pcKey, uHash, uKeyLength);
+    
+    if (pBinding == NULL) {
+        pBinding = SymTable_insert(oSymTable, ppBucket, pcKey, uHash,
+                                   uKeyLength, pvValue);
+        iAdded = pBinding != NULL ? 1 : -1;
+    }
+    
+    if (piAdded != NULL)
+        *piAdded = iAdded;
+    return pBinding != NULL ? (void *)pBinding->pvValue : NULL;
+}
+
+static void *SymTable_doGetFound(SymTable_T oSymTable, const char *pcKey,
+                                 int *piFound) {
+    size_t uHash;
+    size_t uKeyLength;
+    Binding *pBinding;
+    
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(piFound != NULL);
+    
+    uHash = SymTable_hash(oSymTable, pcKey, &uKeyLength);
+    pBinding = SymTable_findIn(oSymTable, *SymTable_bucketFor(oSymTable, uHash),
+                               pcKey, uHash, uKeyLength);
+    
+    *piFound = pBinding != NULL;
+    return pBinding != NULL ? (void *)pBinding->pvValue : NULL;
+}
+
+static void **SymTable_doEntry(SymTable_T oSymTable, const char *pcKey,
+                               int *piCreated) {
+    Binding **ppBucket;
+    size_t uHash;
+    size_t uKeyLength;
+    Binding *pBinding;
+    int iCreated = 0;
+    
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    
+    uHash = SymTable_hash(oSymTable, pcKey, &uKeyLength);
+    ppBucket = SymTable_bucketFor(oSymTable, uHash);
+    pBinding = SymTable_findIn(oSymTable, *ppBucket, pcKey, uHash, uKeyLength);
+    
+    if (pBinding == NULL) {
+        pBinding = SymTable_insert(oSymTable, ppBucket, pcKey, uHash,
+                                   uKeyLength, NULL);
+        iCreated = pBinding != NULL;
+    }
+    
+    if (piCreated != NULL)
+        *piCreated = iCreated;
+    return pBinding != NULL ? (void **)&pBinding->pvValue : NULL;
+}
+
+static size_t SymTable_doGetMany(SymTable_T oSymTable, const char *apcKeys[],
+                                 size_t uCount, void *apvValues[]) {
+    size_t auHashes[GET_MANY_BATCH];
+    size_t auKeyLengths[GET_MANY_BATCH];
+    Binding **appBuckets[GET_MANY_BATCH];
+    Binding *apCurrent[GET_MANY_BATCH];
+    size_t uStart;
+    size_t uBatch;
+    size_t uActive;
+    size_t uFound = 0;
+    size_t i;
+    
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL);
+    assert(apvValues != NULL);
+    
+    for (uStart = 0; uStart < uCount; uStart += uBatch) {
+        uBatch = uCount - uStart < GET_MANY_BATCH ? uCount - uStart
+                                                  : GET_MANY_BATCH;
+    
+        /* Hash every key of the batch and start loading its bucket */
+        for (i = 0; i < uBatch; i++) {
+            assert(apcKeys[uStart + i] != NULL);
+            auHashes[i] = SymTable_hash(oSymTable, apcKeys[uStart + i],
+                                        &auKeyLengths[i]);
+            appBuckets[i] = SymTable_bucketFor(oSymTable, auHashes[i]);
+            PREFETCH(appBuckets[i]);
+            apvValues[uStart + i] = NULL;
+        }
+    
+        /* By now the buckets have arrived: start loading each chain's
+         * first binding */
+        for (i = 0; i < uBatch; i++) {
+            apCurrent[i] = *appBuckets[i];
+            PREFETCH(apCurrent[i]);
+        }
+    
+        /* Advance every chain one binding per round, prefetching the
+         * next, so that the misses of different chains overlap */
+        do {
+            uActive = 0;
+            for (i = 0; i < uBatch; i++) {
+                if (apCurrent[i] == NULL)
+                    continue;
+                if (SymTable_matches(oSymTable, apCurrent[i],
+                                     apcKeys[uStart + i], auHashes[i],
+                                     auKeyLengths[i])) {
+                    apvValues[uStart + i] = (void *)apCurrent[i]->pvValue;
+                    apCurrent[i] = NULL;
+                    uFound++;
+                    continue;
+                }
+                apCurrent[i] = apCurrent[i]->pNext;
+                if (apCurrent[i] != NULL) {
+                    PREFETCH(apCurrent[i]);
+                    uActive++;
+                }
+            }
+        } while (uActive > 0);
+    }
+    
+    return uFound;
+}
+
+static size_t SymTable_doGetManyInterleaved(SymTable_T oSymTable,
+                                            const char *apcKeys[],
+                                            size_t uCount, void *apvValues[],
+                                            size_t uWidth) {
+    Lookup asLookups[SYMTABLE_MAX_INTERLEAVE];
+    size_t uNext = 0;
+    size_t uInFlight = 0;
+    size_t uFound = 0;
+    size_t i;
+    
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL);
+    assert(apvValues != NULL);
+    assert(uWidth >= 1 && uWidth <= SYMTABLE_MAX_INTERLEAVE);
+    
+    /* Fill the ring */
+    for (i = 0; i < uWidth; i++) {
+        asLookups[i].iStage = LOOKUP_IDLE;
+        if (uNext < uCount) {
+            SymTable_startLookup(oSymTable, &asLookups[i], apcKeys, uNext++);
+            uInFlight++;
+        }
+    }
+    
+    /* Step each search in turn, so that by the time a search comes round
+     * again its prefetch has landed. A finished search makes room for the
+     * next key at once, however long the other chains are. */
+    for (i = 0; uInFlight > 0; i = i + 1 == uWidth ? 0 : i + 1) {
+        if (asLookups[i].iStage == LOOKUP_IDLE ||
+            !SymTable_stepLookup(oSymTable, &asLookups[i], apcKeys,
+                                 apvValues, &uFound))
+            continue;
+        
+        if (uNext < uCount)
+            SymTable_startLookup(oSymTable, &asLookups[i], apcKeys, uNext++);
+        else {
+            asLookups[i].iStage = LOOKUP_IDLE;
+            uInFlight--;
+        }
+    }
+    
+    return uFound;
+}
+
+static size_t SymTable_doPutMany(SymTable_T oSymTable, const char *apcKeys[],
+                                 const void *apvValues[], size_t uCount,
+                                 int aiAdded[]) {
+    size_t auHashes[GET_MANY_BATCH];
+    size_t auKeyLengths[GET_MANY_BATCH];
+    Binding **ppBucket;
+    size_t uPrimeIndex;
+    size_t uBucketCount;
+    size_t uStart;
+    size_t uBatch;
+    size_t uAdded = 0;
+    size_t i;
+    int iAdded;
+    
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL);
+    assert(apvValues != NULL);
+    
+    /* Grow once, straight to a bucket count that holds every key, so that
+     * no insert below crosses an expansion threshold. Unlike
+     * SymTable_reserve, this does not stop the table shrinking later. If
+     * it fails, the inserts expand the table as they need to. */
+    if (uCount <= (size_t)-1 - oSymTable->uLength) {
+        uPrimeIndex = SymTable_stepFor(oSymTable->uLength + uCount,
+                                       &uBucketCount);
+        if (uBucketCount > oSymTable->uBucketCount)
+            (void)SymTable_resize(oSymTable, uPrimeIndex, uBucketCount);
+    }
+    
+    for (uStart = 0; uStart < uCount; uStart += uBatch) {
+        uBatch = uCount - uStart < GET_MANY_BATCH ? uCount - uStart
+                                                  : GET_MANY_BATCH;
+    
+        /* Hash the batch in one tight loop, prefetching the buckets */
+        for (i = 0; i < uBatch; i++) {
+            assert(apcKeys[uStart + i] != NULL);
+            auHashes[i] = SymTable_hash(oSymTable, apcKeys[uStart + i],
+                                        &auKeyLengths[i]);
+            PREFETCH(SymTable_bucketFor(oSymTable, auHashes[i]));
+        }
+    
+        /* Then insert. The bucket is looked up again because each insert
+         * may advance an incremental resize. */
+        for (i = 0; i < uBatch; i++) {
+            ppBucket = SymTable_bucketFor(oSymTable, auHashes[i]);
+            iAdded = SymTable_findIn(oSymTable, *ppBucket, apcKeys[uStart + i],
+                                     auHashes[i], auKeyLengths[i]) == NULL &&
+                     SymTable_insert(oSymTable, ppBucket, apcKeys[uStart + i],
+                                     auHashes[i], auKeyLengths[i],
+                                     apvValues[uStart + i]) != NULL;
+            if (aiAdded != NULL)
+                aiAdded[uStart + i] = iAdded;
+            uAdded += (size_t)iAdded;
+        }
+    }
+    
+    return uAdded;
+}
+
+static void SymTable_doMapParallel(SymTable_T oSymTable,
+                                   void (*pfApply)(const char *pcKey,
+                                                   void *pvValue,
+                                                   void *pvExtra),
+                                   const void *pvExtra, size_t uThreads) {
+    MapJob sJob;
+    size_t uBucketCount;
+    
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    assert(uThreads >= 1);
+    
+    sJob.oSymTable = oSymTable;
+    sJob.pfApply = pfApply;
+    sJob.pvExtra = (void *)pvExtra;
+    
+    uBucketCount = oSymTable->uBucketCount;
+    if (oSymTable->ppOldBuckets != NULL)
+        uBucketCount += oSymTable->uOldBucketCount - oSymTable->uMigrateIndex;
+    
+    Parallel_forRanges(uBucketCount, uThreads, SymTable_mapRange, &sJob);
+}
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+    int iResult;
+    
+    TRACE_START();
+    iResult = SymTable_doReserve(oSymTable, uCapacity);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_RESERVE);
+    return iResult;
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+    size_t uLength;
+    
+    TRACE_START();
+    uLength = SymTable_doGetLength(oSymTable);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_LENGTH);
+    return uLength;
+}
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    int iResult;
+    
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    iResult = SymTable_doPut(oSymTable, pcKey, pvValue);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_PUT,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return iResult;
+}
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    void *pvOld;
+    
+    TRACE_START();
+    pvOld = SymTable_doReplace(oSymTable, pcKey, pvValue);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_REPLACE);
+    return pvOld;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    int iResult;
+    
+    TRACE_START();
+    iResult = SymTable_doContains(oSymTable, pcKey);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_CONTAINS);
+    return iResult;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    void *pvValue;
+    
+    TRACE_START();
+    pvValue = SymTable_doGet(oSymTable, pcKey);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET);
+    return pvValue;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    void *pvValue;
+    
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    pvValue = SymTable_doRemove(oSymTable, pcKey);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_REMOVE,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return pvValue;
+}
+
+void SymTable_map(SymTable_T oSymTable,
+                  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                  const void *pvExtra) {
+    TRACE_START();
+    SymTable_doMap(oSymTable, pfApply, pvExtra);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_MAP);
+}
+
+int SymTable_upsert(SymTable_T oSymTable, const char *pcKey, const void *pvValue,
+                    void **ppvOldValue) {
+    int iResult;
+    
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    iResult = SymTable_doUpsert(oSymTable, pcKey, pvValue, ppvOldValue);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_UPSERT,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return iResult;
+}
+
+void *SymTable_getOrPut(SymTable_T oSymTable, const char *pcKey,
+                        const void *pvValue, int *piAdded) {
+    void *pvResult;
+    
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    pvResult = SymTable_doGetOrPut(oSymTable, pcKey, pvValue, piAdded);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_GET_OR_PUT,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return pvResult;
+}
+
+void *SymTable_getFound(SymTable_T oSymTable, const char *pcKey, int *piFound) {
+    void *pvValue;
+    
+    TRACE_START();
+    pvValue = SymTable_doGetFound(oSymTable, pcKey, piFound);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_FOUND);
+    return pvValue;
+}
+
+void **SymTable_entry(SymTable_T oSymTable, const char *pcKey, int *piCreated) {
+    void **ppvValue;
+    
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    ppvValue = SymTable_doEntry(oSymTable, pcKey, piCreated);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_ENTRY,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return ppvValue;
+}
+
+size_t SymTable_getMany(SymTable_T oSymTable, const char *apcKeys[],
+                        size_t uCount, void *apvValues[]) {
+    size_t uFound;
+    
+    TRACE_START();
+    uFound = SymTable_doGetMany(oSymTable, apcKeys, uCount, apvValues);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_MANY);
+    return uFound;
+}
+
+size_t SymTable_getManyInterleaved(SymTable_T oSymTable, const char *apcKeys[],
+                                   size_t uCount, void *apvValues[],
+                                   size_t uWidth) {
+    size_t uFound;
+    
+    TRACE_START();
+    uFound = SymTable_doGetManyInterleaved(oSymTable, apcKeys, uCount,
+                                           apvValues, uWidth);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_MANY_INTERLEAVED);
+    return uFound;
+}
+
+size_t SymTable_putMany(SymTable_T oSymTable, const char *apcKeys[],
+                        const void *apvValues[], size_t uCount, int aiAdded[]) {
+    size_t uAdded;
+    
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    uAdded = SymTable_doPutMany(oSymTable, apcKeys, apvValues, uCount,
+                                aiAdded);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_PUT_MANY,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return uAdded;
+}
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+                          void (*pfApply)(const char *pcKey, void *pvValue,
+                                          void *pvExtra),
+                          const void *pvExtra, size_t uThreads) {
+    TRACE_START();
+    SymTable_doMapParallel(oSymTable, pfApply, pvExtra, uThreads);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_MAP_PARALLEL);
+}
+
+/* Iterators are not timed by -DSYMTABLE_TRACE: a call of
+ * SymTable_iterNext costs less than reading the clock. */
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable) {
+    SymTableIter_T oIter;
+    
+    assert(oSymTable != NULL);
+    
+    oIter = oSymTable->pfAlloc(sizeof(struct SymTableIter),
+                               oSymTable->pvAllocExtra);
+    if (oIter == NULL)
+        return NULL;
+    
+    oIter->oSymTable = oSymTable;
+    /* Start with the old buckets still to migrate, if any */
+    if (oSymTable->ppOldBuckets != NULL) {
+        oIter->ppBuckets = oSymTable->ppOldBuckets;
+        oIter->uBucketCount = oSymTable->uOldBucketCount;
+        oIter->uNextBucket = oSymTable->uMigrateIndex;
+    }
+    else {
+        oIter->ppBuckets = oSymTable->ppBuckets;
+        oIter->uBucketCount = oSymTable->uBucketCount;
+        oIter->uNextBucket = 0;
+    }
+    oIter->pNext = NULL;
+    
+    return oIter;
+}
+
+int SymTable_iterNext(SymTableIter_T oIter, const char **ppcKey,
+                      void **ppvValue) {
+    Binding *pBinding;
+    
+    assert(oIter != NULL);
+    
+    while (oIter->pNext == NULL) {
+        if (oIter->uNextBucket == oIter->uBucketCount) {
+            /* Move from the old buckets to the current ones, or stop */
+            if (oIter->ppBuckets == oIter->oSymTable->ppBuckets)
+                return 0;
+            oIter->ppBuckets = oIter->oSymTable->ppBuckets;
+            oIter->uBucketCount = oIter->oSymTable->uBucketCount;
+            oIter->uNextBucket = 0;
+            continue;
+        }
+        oIter->pNext = oIter->ppBuckets[oIter->uNextBucket++];
+    }
+    
+    pBinding = oIter->pNext;
+    oIter->pNext = pBinding->pNext;
+    
+    if (ppcKey != NULL)
+        *ppcKey = pBinding->acKey;
+    if (ppvValue != NULL)
+        *ppvValue = (void *)pBinding->pvValue;
+    return 1;
+}
+
+void SymTable_iterEnd(SymTableIter_T oIter) {
+    assert(oIter != NULL);
+    
+    oIter->oSymTable->pfFree(oIter, sizeof(struct SymTableIter),
+                             oIter->oSymTable->pvAllocExtra);
+}
+
+/* Adds a bucket whose chain holds uChainLength bindings to the chain
+ * counts of *psStats */
+static void SymTable_addChain(SymTable_Stats *psStats, size_t uChainLength) {
+    if (uChainLength == 0)
+        psStats->uEmptyBuckets++;
+    if (uChainLength > psStats->uMaxChainLength)
+        psStats->uMaxChainLength = uChainLength;
+    
+    if (uChainLength > SYMTABLE_HISTOGRAM_SIZE - 1)
+        uChainLength = SYMTABLE_HISTOGRAM_SIZE - 1;
+    psStats->auChainLengths[uChainLength]++;
+}
+
+/* Returns the number of bindings in the chain starting at pBinding */
+static size_t SymTable_chainLength(const Binding *pBinding) {
+    size_t uChainLength = 0;
+    
+    for (; pBinding != NULL; pBinding = pBinding->pNext)
+        uChainLength++;
+    
+    return uChainLength;
+}
+
+int SymTable_getStats(SymTable_T oSymTable, SymTable_Stats *psStats) {
+    size_t i;
+    
+    assert(oSymTable != NULL);
+    assert(psStats != NULL);
+    
+    memset(psStats, 0, sizeof(*psStats));
+    psStats->uLength = oSymTable->uLength;
+    psStats->uBucketCount = oSymTable->uBucketCount;
+    psStats->uGrowthStep = oSymTable->uPrimeIndex;
+    psStats->uExpansions = oSymTable->uExpansions;
+    psStats->uShrinks = oSymTable->uShrinks;
+    TRACE_STATS(oSymTable, psStats);
+    
+    /* Old buckets not yet migrated are still searched, so they count as
+     * buckets too */
+    if (oSymTable->ppOldBuckets != NULL) {
+        for (i = oSymTable->uMigrateIndex; i < oSymTable->uOldBucketCount; i++)
+            SymTable_addChain(psStats,
+                              SymTable_chainLength(oSymTable->ppOldBuckets[i]));
+        psStats->uBucketCount += oSymTable->uOldBucketCount -
+                                 oSymTable->uMigrateIndex;
+    }
+    
+    for (i = 0; i < oSymTable->uBucketCount; i++)
+        SymTable_addChain(psStats, SymTable_chainLength(oSymTable->ppBuckets[i]));
+    
+    if (psStats->uLength > 0)
+        psStats->dMeanChainLength = (double)psStats->uLength /
+            (double)(psStats->uBucketCount - psStats->uEmptyBuckets);
+    
+    return 1;
+}
+
+int SymTable_getLatencyHistogram(SymTable_T oSymTable, enum SymTable_Op eOp,
+                                 unsigned long aulCounts[]) {
+    assert(oSymTable != NULL);
+    assert(eOp < SYMTABLE_OP_COUNT);
+    assert(aulCounts != NULL);
+    
+#ifdef SYMTABLE_TRACE
+    memcpy(aulCounts, oSymTable->aaulLatencies[eOp],
+           sizeof(oSymTable->aaulLatencies[eOp]));
+    return 1;
+#else
+    (void)oSymTable;
+    (void)eOp;
+    (void)aulCounts;
+    return 0;
+#endif
+}
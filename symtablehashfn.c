@@ -0,0 +1,269 @@
+/* Author: Nicholas Budny */
+
+/* symtablehashfn.c - The hash functions that SymTable clients can pass
+ * to SymTable_newWithHash, and the seeding of SymTable_newSeeded */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "symtable.h"
+#include "symtablehashfn.h"
+
+/* The original default secrets of wyhash, which its final version 4.2
+ * replaced with new ones. SymTable_hashWyhash follows the final version
+ * 4 algorithm but keeps these secrets, so its hashes do not match the
+ * 4.2 test vectors. */
+static const unsigned long long WY_SECRET0 = 0xa0761d6478bd642fULL;
+static const unsigned long long WY_SECRET1 = 0xe7037ed1a0b428dbULL;
+static const unsigned long long WY_SECRET2 = 0x8ebc6af09c88c6e3ULL;
+static const unsigned long long WY_SECRET3 = 0x589965cc75374cc3ULL;
+
+size_t SymTable_hash65599(const char *pcKey, size_t uKeyLength,
+                          const void *pvHashExtra) {
+    const size_t HASH_MULTIPLIER = 65599;
+    size_t uHash = 0;
+    size_t u;
+
+    assert(pcKey != NULL);
+
+    (void)pvHashExtra;
+    for (u = 0; u < uKeyLength; u++)
+        uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+
+    return uHash;
+}
+
+/* Stores the low and high halves of the 128-bit product of *pullLow and
+ * *pullHigh in *pullLow and *pullHigh */
+static void SymTable_multiply(unsigned long long *pullLow,
+                              unsigned long long *pullHigh) {
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 Product;
+    Product uProduct = (Product)*pullLow * *pullHigh;
+
+    *pullLow = (unsigned long long)uProduct;
+    *pullHigh = (unsigned long long)(uProduct >> 64);
+#else
+    /* Schoolbook multiplication of 32-bit halves */
+    unsigned long long ullA = *pullLow;
+    unsigned long long ullB = *pullHigh;
+    unsigned long long ullLowLow = (ullA & 0xffffffffULL) * (ullB & 0xffffffffULL);
+    unsigned long long ullLowHigh = (ullA & 0xffffffffULL) * (ullB >> 32);
+    unsigned long long ullHighLow = (ullA >> 32) * (ullB & 0xffffffffULL);
+    unsigned long long ullHighHigh = (ullA >> 32) * (ullB >> 32);
+    unsigned long long ullMiddle = (ullLowLow >> 32) +
+                                   (ullLowHigh & 0xffffffffULL) +
+                                   (ullHighLow & 0xffffffffULL);
+
+    *pullLow = (ullMiddle << 32) | (ullLowLow & 0xffffffffULL);
+    *pullHigh = ullHighHigh + (ullLowHigh >> 32) + (ullHighLow >> 32) +
+                (ullMiddle >> 32);
+#endif
+}
+
+/* Returns the two halves of the 128-bit product of ullA and ullB,
+ * combined by exclusive or */
+static unsigned long long SymTable_mix(unsigned long long ullA,
+                                       unsigned long long ullB) {
+    SymTable_multiply(&ullA, &ullB);
+    return ullA ^ ullB;
+}
+
+/* Returns the 8 bytes at pcBytes as an integer */
+static unsigned long long SymTable_read8(const char *pcBytes) {
+    unsigned long long ullValue;
+
+    memcpy(&ullValue, pcBytes, sizeof(ullValue));
+    return ullValue;
+}
+
+/* Returns the 4 bytes at pcBytes as an integer */
+static unsigned long long SymTable_read4(const char *pcBytes) {
+    unsigned int uiValue;
+
+    memcpy(&uiValue, pcBytes, sizeof(uiValue));
+    return uiValue;
+}
+
+size_t SymTable_hashWyhash(const char *pcKey, size_t uKeyLength,
+                           const void *pvHashExtra) {
+    const unsigned char *pucKey = (const unsigned char *)pcKey;
+    unsigned long long ullSeed = 0;
+    unsigned long long ullSeed1;
+    unsigned long long ullSeed2;
+    unsigned long long ullA;
+    unsigned long long ullB;
+    size_t uLeft = uKeyLength;
+
+    assert(pcKey != NULL);
+
+    if (pvHashExtra != NULL)
+        ullSeed = *(const unsigned long long *)pvHashExtra;
+    ullSeed ^= SymTable_mix(ullSeed ^ WY_SECRET0, WY_SECRET1);
+
+    if (uKeyLength <= 16) {
+        if (uKeyLength >= 4) {
+            /* Two overlapping 4-byte reads from each end cover 4..16 */
+            ullA = (SymTable_read4(pcKey) << 32) |
+                   SymTable_read4(pcKey + ((uKeyLength >> 3) << 2));
+            ullB = (SymTable_read4(pcKey + uKeyLength - 4) << 32) |
+                   SymTable_read4(pcKey + uKeyLength - 4 -
+                                  ((uKeyLength >> 3) << 2));
+        }
+        else if (uKeyLength > 0) {
+            ullA = ((unsigned long long)pucKey[0] << 16) |
+                   ((unsigned long long)pucKey[uKeyLength >> 1] << 8) |
+                   pucKey[uKeyLength - 1];
+            ullB = 0;
+        }
+        else
+            ullA = ullB = 0;
+    }
+    else {
+        /* Three independent lanes keep long keys off a single chain of
+         * dependent multiplies */
+        if (uLeft > 48) {
+            ullSeed1 = ullSeed;
+            ullSeed2 = ullSeed;
+            do {
+                ullSeed = SymTable_mix(SymTable_read8(pcKey) ^ WY_SECRET1,
+                                       SymTable_read8(pcKey + 8) ^ ullSeed);
+                ullSeed1 = SymTable_mix(SymTable_read8(pcKey + 16) ^ WY_SECRET2,
+                                        SymTable_read8(pcKey + 24) ^ ullSeed1);
+                ullSeed2 = SymTable_mix(SymTable_read8(pcKey + 32) ^ WY_SECRET3,
+                                        SymTable_read8(pcKey + 40) ^ ullSeed2);
+                pcKey += 48;
+                uLeft -= 48;
+            } while (uLeft > 48);
+            ullSeed ^= ullSeed1 ^ ullSeed2;
+        }
+        while (uLeft > 16) {
+            ullSeed = SymTable_mix(SymTable_read8(pcKey) ^ WY_SECRET1,
+                                   SymTable_read8(pcKey + 8) ^ ullSeed);
+            pcKey += 16;
+            uLeft -= 16;
+        }
+        /* The last 16 bytes, which may overlap ones already read */
+        ullA = SymTable_read8(pcKey + uLeft - 16);
+        ullB = SymTable_read8(pcKey + uLeft - 8);
+    }
+
+    ullA ^= WY_SECRET1;
+    ullB ^= ullSeed;
+    SymTable_multiply(&ullA, &ullB);
+    return (size_t)SymTable_mix(ullA ^ WY_SECRET0 ^ (unsigned long long)uKeyLength,
+                                ullB ^ WY_SECRET1);
+}
+
+/* Returns ullValue rotated left by iBits, 0 < iBits < 64 */
+static unsigned long long SymTable_rotate(unsigned long long ullValue,
+                                          int iBits) {
+    return (ullValue << iBits) | (ullValue >> (64 - iBits));
+}
+
+/* Returns the 8 bytes at pucBytes as a little-endian integer */
+static unsigned long long SymTable_readLittle8(const unsigned char *pucBytes) {
+    unsigned long long ullValue = 0;
+    int i;
+
+    for (i = 7; i >= 0; i--)
+        ullValue = (ullValue << 8) | pucBytes[i];
+    return ullValue;
+}
+
+/* One SipRound over the state aullV */
+static void SymTable_sipRound(unsigned long long aullV[4]) {
+    aullV[0] += aullV[1];
+    aullV[1] = SymTable_rotate(aullV[1], 13) ^ aullV[0];
+    aullV[0] = SymTable_rotate(aullV[0], 32);
+    aullV[2] += aullV[3];
+    aullV[3] = SymTable_rotate(aullV[3], 16) ^ aullV[2];
+    aullV[0] += aullV[3];
+    aullV[3] = SymTable_rotate(aullV[3], 21) ^ aullV[0];
+    aullV[2] += aullV[1];
+    aullV[1] = SymTable_rotate(aullV[1], 17) ^ aullV[2];
+    aullV[2] = SymTable_rotate(aullV[2], 32);
+}
+
+size_t SymTable_hashSiphash13(const char *pcKey, size_t uKeyLength,
+                              const void *pvHashExtra) {
+    const unsigned char *pucKey = (const unsigned char *)pcKey;
+    const unsigned long long *pullSeed = pvHashExtra;
+    unsigned long long aullV[4];
+    unsigned long long ullBlock;
+    size_t uLeft;
+    size_t u;
+
+    assert(pcKey != NULL);
+    assert(pvHashExtra != NULL);
+
+    aullV[0] = pullSeed[0] ^ 0x736f6d6570736575ULL;
+    aullV[1] = pullSeed[1] ^ 0x646f72616e646f6dULL;
+    aullV[2] = pullSeed[0] ^ 0x6c7967656e657261ULL;
+    aullV[3] = pullSeed[1] ^ 0x7465646279746573ULL;
+
+    /* One compression round per 8-byte block */
+    for (uLeft = uKeyLength; uLeft >= 8; uLeft -= 8, pucKey += 8) {
+        ullBlock = SymTable_readLittle8(pucKey);
+        aullV[3] ^= ullBlock;
+        SymTable_sipRound(aullV);
+        aullV[0] ^= ullBlock;
+    }
+
+    /* The last block holds the remaining bytes and the length */
+    ullBlock = (unsigned long long)uKeyLength << 56;
+    for (u = 0; u < uLeft; u++)
+        ullBlock |= (unsigned long long)pucKey[u] << (8 * u);
+    aullV[3] ^= ullBlock;
+    SymTable_sipRound(aullV);
+    aullV[0] ^= ullBlock;
+
+    /* Three finalization rounds */
+    aullV[2] ^= 0xff;
+    SymTable_sipRound(aullV);
+    SymTable_sipRound(aullV);
+    SymTable_sipRound(aullV);
+
+    return (size_t)(aullV[0] ^ aullV[1] ^ aullV[2] ^ aullV[3]);
+}
+
+/* Returns the next output of a splitmix64 generator with state
+ * *pullState */
+static unsigned long long SymTable_splitmix(unsigned long long *pullState) {
+    unsigned long long ullValue;
+
+    *pullState += 0x9e3779b97f4a7c15ULL;
+    ullValue = *pullState;
+    ullValue = (ullValue ^ (ullValue >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    ullValue = (ullValue ^ (ullValue >> 27)) * 0x94d049bb133111ebULL;
+    return ullValue ^ (ullValue >> 31);
+}
+
+void HashFn_randomSeed(unsigned long long aullSeed[2]) {
+    unsigned long long ullState;
+    FILE *psFile;
+    size_t uRead = 0;
+
+    assert(aullSeed != NULL);
+
+    /* Unbuffered, so that only the 16 bytes needed are read rather than
+     * a whole stdio buffer */
+    psFile = fopen("/dev/urandom", "rb");
+    if (psFile != NULL) {
+        if (setvbuf(psFile, NULL, _IONBF, 0) == 0)
+            uRead = fread(aullSeed, sizeof(unsigned long long), 2, psFile);
+        fclose(psFile);
+    }
+    if (uRead == 2)
+        return;
+
+    /* aullSeed lies inside its table, so its address differs between the
+     * tables alive at once, with no shared state to race on */
+    ullState = (unsigned long long)time(NULL) ^
+               ((unsigned long long)clock() << 32) ^
+               (unsigned long long)(size_t)&ullState ^
+               ((unsigned long long)(size_t)aullSeed << 16);
+    aullSeed[0] = SymTable_splitmix(&ullState);
+    aullSeed[1] = SymTable_splitmix(&ullState);
+}
@@ -0,0 +1,18 @@
+/* Author: Nicholas Budny */
+
+/* symtablehashfn.h - Seeding for the keyed hash of SymTable_newSeeded,
+ * shared by the SymTable implementations. The hash functions themselves
+ * are declared in symtable.h. */
+
+#ifndef SYMTABLEHASHFN_H
+#define SYMTABLEHASHFN_H
+
+/* Fills aullSeed with a fresh unpredictable key for
+ * SymTable_hashSiphash13, read from /dev/urandom. Where that cannot be
+ * read, falls back to mixing the time, the processor clock and an
+ * address, which is much weaker but still differs between tables.
+ * aullSeed must not be NULL.
+ */
+void HashFn_randomSeed(unsigned long long aullSeed[2]);
+
+#endif
@@ -6,17 +6,20 @@
 #include <stdlib.h>
 #include <string.h>
 #include "symtable.h"
+#include "symtablearena.h"
+#include "symtabletrace.h"
 
 /* A Binding structure represents a single key-value binding in the table.
- * Each node in the linked list is a Binding.
+ * Each node in the linked list is a Binding. The key is stored inline
+ * after the node header, so a binding is a single allocation.
  */
 typedef struct Binding {
-    /* Defensive copy of the key string */
-    char *pcKey;
     /* Value associated with the key (client-owned) */
     const void *pvValue;
     /* Pointer to the next binding in the list */
     struct Binding *pNext;
+    /* Defensive copy of the key string */
+    char acKey[];
 } Binding;
 
 /* The SymTable structure represents the entire symbol table.
@@ -27,18 +30,151 @@ struct SymTable {
     Binding *pHead;
     /* Number of bindings in the table */
     size_t uLength;
+    /* Arena that bindings are allocated from, or NULL to use pfAlloc */
+    Arena_T oArena;
+    /* Allocation functions for the table and its bindings */
+    void *(*pfAlloc)(size_t uSize, void *pvAllocExtra);
+    void (*pfFree)(void *pvBlock, size_t uSize, void *pvAllocExtra);
+    /* Context passed to pfAlloc and pfFree */
+    void *pvAllocExtra;
+    /* Latency histograms and search counts, when built with
+     * -DSYMTABLE_TRACE */
+    TRACE_MEMBERS
+};
+
+/* A SymTableIter structure is a position in the list of a table. */
+struct SymTableIter {
+    /* Table being iterated over */
+    SymTable_T oSymTable;
+    /* Next binding to return, or NULL at the end of the list */
+    Binding *pNext;
 };
 
+/* Allocates uSize bytes with malloc; the allocator of tables created
+ * without one of their own */
+static void *SymTable_defaultAlloc(size_t uSize, void *pvAllocExtra) {
+    (void)pvAllocExtra;
+    return malloc(uSize);
+}
+
+/* Frees pvBlock with free; the counterpart of SymTable_defaultAlloc */
+static void SymTable_defaultFree(void *pvBlock, size_t uSize,
+                                 void *pvAllocExtra) {
+    (void)uSize;
+    (void)pvAllocExtra;
+    free(pvBlock);
+}
+
+/* Allocates a binding of uSize bytes, key included, from the arena of
+ * oSymTable or else with its allocator.
+ * Returns NULL if insufficient memory is available.
+ * oSymTable must not be NULL.
+ */
+static Binding *SymTable_allocBinding(SymTable_T oSymTable, size_t uSize) {
+    assert(oSymTable != NULL);
+    
+    if (oSymTable->oArena != NULL)
+        return Arena_alloc(oSymTable->oArena, uSize);
+    return oSymTable->pfAlloc(uSize, oSymTable->pvAllocExtra);
+}
+
+/* Frees pBinding, which was allocated by SymTable_allocBinding. An arena
+ * keeps the binding on a free list for reuse.
+ * oSymTable and pBinding must not be NULL.
+ */
+static void SymTable_freeBinding(SymTable_T oSymTable, Binding *pBinding) {
+    size_t uSize;
+    
+    assert(oSymTable != NULL);
+    assert(pBinding != NULL);
+    
+    uSize = sizeof(Binding) + strlen(pBinding->acKey) + 1;
+    if (oSymTable->oArena != NULL)
+        Arena_release(oSymTable->oArena, pBinding, uSize);
+    else
+        oSymTable->pfFree(pBinding, uSize, oSymTable->pvAllocExtra);
+}
+
+/* Returns 1 if pBinding, examined by a search of oSymTable, holds the
+ * key pcKey, or 0 otherwise.
+ */
+static int SymTable_matches(SymTable_T oSymTable, const Binding *pBinding,
+                            const char *pcKey) {
+    TRACE_PROBE(oSymTable);
+    TRACE_KEY_COMPARE(oSymTable);
+    return strcmp(pBinding->acKey, pcKey) == 0;
+}
+
 SymTable_T SymTable_new(void) {
-    /* Allocate memory for the SymTable structure */
-    SymTable_T oSymTable = malloc(sizeof(struct SymTable));
+    return SymTable_newWithAllocator(SymTable_defaultAlloc,
+                                     SymTable_defaultFree, NULL);
+}
+
+SymTable_T SymTable_newWithAllocator(
+    void *(*pfAlloc)(size_t uSize, void *pvAllocExtra),
+    void (*pfFree)(void *pvBlock, size_t uSize, void *pvAllocExtra),
+    void *pvAllocExtra) {
+    SymTable_T oSymTable;
+    
+    assert(pfAlloc != NULL);
+    assert(pfFree != NULL);
     
+    /* Allocate memory for the SymTable structure */
+    oSymTable = pfAlloc(sizeof(struct SymTable), pvAllocExtra);
     if (oSymTable == NULL)
         return NULL;
     
     /* Initialize the empty table with no bindings */
     oSymTable->pHead = NULL;
     oSymTable->uLength = 0;
+    oSymTable->oArena = NULL;
+    oSymTable->pfAlloc = pfAlloc;
+    oSymTable->pfFree = pfFree;
+    oSymTable->pvAllocExtra = pvAllocExtra;
+    TRACE_INIT(oSymTable);
+    
+    return oSymTable;
+}
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+    /* A linked list has nothing to presize */
+    (void)uCapacity;
+    
+    return SymTable_new();
+}
+
+SymTable_T SymTable_newWithHash(
+    size_t (*pfHash)(const char *pcKey, size_t uKeyLength,
+                     const void *pvHashExtra),
+    const void *pvHashExtra) {
+    assert(pfHash != NULL);
+    
+    /* A linked list never hashes its keys */
+    (void)pfHash;
+    (void)pvHashExtra;
+    
+    return SymTable_new();
+}
+
+SymTable_T SymTable_newSeeded(void) {
+    /* A linked list never hashes its keys, so no key set can make it
+     * slower than it always is */
+    return SymTable_new();
+}
+
+SymTable_T SymTable_newArena(void) {
+    SymTable_T oSymTable;
+    
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+        return NULL;
+    
+    /* Bindings come from the arena from the first put on */
+    oSymTable->oArena = Arena_new();
+    if (oSymTable->oArena == NULL) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
     
     return oSymTable;
 }
@@ -49,6 +185,14 @@ void SymTable_free(SymTable_T oSymTable) {
     
     assert(oSymTable != NULL);
     
+    /* An arena frees all bindings at once, slab by slab */
+    if (oSymTable->oArena != NULL) {
+        Arena_free(oSymTable->oArena);
+        oSymTable->pfFree(oSymTable, sizeof(struct SymTable),
+                          oSymTable->pvAllocExtra);
+        return;
+    }
+    
     /* Start traversal at the head of the list */
     pCurrent = oSymTable->pHead;
     
@@ -58,50 +202,51 @@ void SymTable_free(SymTable_T oSymTable) {
         pTemp = pCurrent;
         pCurrent = pCurrent->pNext;
         
-        /* Free the key string */
-        free(pTemp->pcKey);
-        
-        /* Free the binding structure itself */
-        free(pTemp);
+        /* Free the binding structure itself, including its key */
+        SymTable_freeBinding(oSymTable, pTemp);
     }
     
     /* Finally, free the SymTable structure */
-    free(oSymTable);
+    oSymTable->pfFree(oSymTable, sizeof(struct SymTable),
+                      oSymTable->pvAllocExtra);
 }
 
-size_t SymTable_getLength(SymTable_T oSymTable) {
-    assert(oSymTable != NULL);
+/* Returns the binding of oSymTable that holds pcKey, or NULL if there
+ * is none.
+ * oSymTable and pcKey must not be NULL.
+ */
+static Binding *SymTable_findBinding(SymTable_T oSymTable, const char *pcKey) {
+    Binding *pCurrent;
     
-    return oSymTable->uLength;
+    for (pCurrent = oSymTable->pHead; pCurrent != NULL; pCurrent = pCurrent->pNext) {
+        if (SymTable_matches(oSymTable, pCurrent, pcKey))
+            return pCurrent;
+    }
+    
+    return NULL;
 }
 
-int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+/* Adds a binding of pcKey to pvValue at the head of the list of
+ * oSymTable. pcKey must not be in the table already.
+ * Returns the new binding, or NULL if insufficient memory is available.
+ * oSymTable and pcKey must not be NULL.
+ */
+static Binding *SymTable_insert(SymTable_T oSymTable, const char *pcKey,
+                                const void *pvValue) {
     Binding *pNew;
-    Binding *pCurrent;
+    size_t uKeySize;
     
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
     
-    /* Check if the key already exists (duplicate keys not allowed) */
-    for (pCurrent = oSymTable->pHead; pCurrent != NULL; pCurrent = pCurrent->pNext) {
-        if (strcmp(pCurrent->pcKey, pcKey) == 0)
-            return 0;
-    }
-    
-    /* Allocate memory for new binding */
-    pNew = malloc(sizeof(Binding));
+    /* Allocate memory for new binding with room for the key */
+    uKeySize = strlen(pcKey) + 1;
+    pNew = SymTable_allocBinding(oSymTable, sizeof(Binding) + uKeySize);
     if (pNew == NULL)
-        return 0;
-    
-    /* Allocate memory for the defensive copy of the key */
-    pNew->pcKey = malloc(strlen(pcKey) + 1);
-    if (pNew->pcKey == NULL) {
-        free(pNew);
-        return 0;
-    }
+        return NULL;
     
     /* Create defensive copy of the key */
-    strcpy(pNew->pcKey, pcKey);
+    memcpy(pNew->acKey, pcKey, uKeySize);
     
     /* Store the value pointer (no defensive copy) */
     pNew->pvValue = pvValue;
@@ -113,10 +258,40 @@ int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
     /* Increment the binding count */
     oSymTable->uLength++;
     
+    return pNew;
+}
+
+/* The operations of symtable.h, which the public functions below time
+ * when built with -DSYMTABLE_TRACE */
+
+static int SymTable_doReserve(SymTable_T oSymTable, size_t uCapacity) {
+    assert(oSymTable != NULL);
+    
+    /* A linked list never resizes, so any capacity is already reserved */
+    (void)oSymTable;
+    (void)uCapacity;
+    
     return 1;
 }
 
-void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+static size_t SymTable_doGetLength(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    
+    return oSymTable->uLength;
+}
+
+static int SymTable_doPut(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    
+    /* Check if the key already exists (duplicate keys not allowed) */
+    if (SymTable_findBinding(oSymTable, pcKey) != NULL)
+        return 0;
+    
+    return SymTable_insert(oSymTable, pcKey, pvValue) != NULL;
+}
+
+static void *SymTable_doReplace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
     Binding *pCurrent;
     const void *pvOld;
     
@@ -125,7 +300,7 @@ void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvVa
     
     /* Search for the key in the list */
     for (pCurrent = oSymTable->pHead; pCurrent != NULL; pCurrent = pCurrent->pNext) {
-        if (strcmp(pCurrent->pcKey, pcKey) == 0) {
+        if (SymTable_matches(oSymTable, pCurrent, pcKey)) {
             /* Key found, save the old value */
             pvOld = pCurrent->pvValue;
             
@@ -140,7 +315,7 @@ void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvVa
     return NULL;
 }
 
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+static int SymTable_doContains(SymTable_T oSymTable, const char *pcKey) {
     Binding *pCurrent;
     
     assert(oSymTable != NULL);
@@ -148,14 +323,14 @@ int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
     
     /* Search for the key in the list */
     for (pCurrent = oSymTable->pHead; pCurrent != NULL; pCurrent = pCurrent->pNext) {
-        if (strcmp(pCurrent->pcKey, pcKey) == 0)
+        if (SymTable_matches(oSymTable, pCurrent, pcKey))
             return 1;
     }
     
     return 0;
 }
 
-void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+static void *SymTable_doGet(SymTable_T oSymTable, const char *pcKey) {
     Binding *pCurrent;
     
     assert(oSymTable != NULL);
@@ -163,14 +338,14 @@ void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
     
     /* Search for the key in the list */
     for (pCurrent = oSymTable->pHead; pCurrent != NULL; pCurrent = pCurrent->pNext) {
-        if (strcmp(pCurrent->pcKey, pcKey) == 0)
+        if (SymTable_matches(oSymTable, pCurrent, pcKey))
             return (void *)pCurrent->pvValue;
     }
     
     return NULL;
 }
 
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+static void *SymTable_doRemove(SymTable_T oSymTable, const char *pcKey) {
     Binding *pCurrent;
     Binding *pPrev = NULL;
     const void *pvValue;
@@ -180,7 +355,7 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
     
     /* Search for the key in the list */
     for (pCurrent = oSymTable->pHead; pCurrent != NULL; pCurrent = pCurrent->pNext) {
-        if (strcmp(pCurrent->pcKey, pcKey) == 0) {
+        if (SymTable_matches(oSymTable, pCurrent, pcKey)) {
             
             /* Handle case where binding is at the head */
             if (pPrev == NULL)
@@ -191,11 +366,8 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
             /* Save the value to return */
             pvValue = pCurrent->pvValue;
             
-            /* Free the key string */
-            free(pCurrent->pcKey);
-            
-            /* Free the binding structure */
-            free(pCurrent);
+            /* Free the binding structure and its key */
+            SymTable_freeBinding(oSymTable, pCurrent);
             
             /* Decrement the count of bindings */
             oSymTable->uLength--;
@@ -210,9 +382,9 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
     return NULL;
 }
 
-void SymTable_map(SymTable_T oSymTable,
-                  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
-                  const void *pvExtra) {
+static void SymTable_doMap(SymTable_T oSymTable,
+                           void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                           const void *pvExtra) {
     Binding *pCurrent;
     
     assert(oSymTable != NULL);
@@ -220,5 +392,387 @@ void SymTable_map(SymTable_T oSymTable,
     
     /* Traverse the list and apply the function to each binding */
     for (pCurrent = oSymTable->pHead; pCurrent != NULL; pCurrent = pCurrent->pNext)
-        pfApply(pCurrent->pcKey, (void *)pCurrent->pvValue, (void *)pvExtra);
-}
\ No newline at end of file
+        pfApply(pCurrent->acKey, (void *)pCurrent->pvValue, (void *)pvExtra);
+}
+
+static int SymTable_doUpsert(SymTable_T oSymTable, const char *pcKey,
+                             const void *pvValue, void **ppvOldValue) {
+    Binding *pBinding;
+    
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    
+    /* One walk of the list, whatever the outcome */
+    pBinding = SymTable_findBinding(oSymTable, pcKey);
+    
+    if (pBinding != NULL) {
+        if (ppvOldValue != NULL)
+            *ppvOldValue = (void *)pBinding->pvValue;
+        pBinding->pvValue = pvValue;
+        return 0;
+    }
+    
+    if (SymTable_insert(oSymTable, pcKey, pvValue) == NULL)
+        return -1;
+    return 1;
+}
+
+static void *SymTable_doGetOrPut(SymTable_T oSymTable, const char *pcKey,
+                                 const void *pvValue, int *piAdded) {
+    Binding *pBinding;
+    int iAdded = 0;
+    
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    
+    pBinding = SymTable_findBinding(oSymTable, pcKey);
+    
+    if (pBinding == NULL) {
+        pBinding = SymTable_insert(oSymTable, pcKey, pvValue);
+        iAdded = pBinding != NULL ? 1 : -1;
+    }
+    
+    if (piAdded != NULL)
+        *piAdded = iAdded;
+    return pBinding != NULL ? (void *)pBinding->pvValue : NULL;
+}
+
+static void *SymTable_doGetFound(SymTable_T oSymTable, const char *pcKey,
+                                 int *piFound) {
+    Binding *pBinding;
+    
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(piFound != NULL);
+    
+    pBinding = SymTable_findBinding(oSymTable, pcKey);
+    
+    *piFound = pBinding != NULL;
+    return pBinding != NULL ? (void *)pBinding->pvValue : NULL;
+}
+
+static void **SymTable_doEntry(SymTable_T oSymTable, const char *pcKey,
+                               int *piCreated) {
+    Binding *pBinding;
+    int iCreated = 0;
+    
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    
+    pBinding = SymTable_findBinding(oSymTable, pcKey);
+    
+    if (pBinding == NULL) {
+        pBinding = SymTable_insert(oSymTable, pcKey, NULL);
+        iCreated = pBinding != NULL;
+    }
+    
+    if (piCreated != NULL)
+        *piCreated = iCreated;
+    return pBinding != NULL ? (void **)&pBinding->pvValue : NULL;
+}
+
+static size_t SymTable_doGetMany(SymTable_T oSymTable, const char *apcKeys[],
+                                 size_t uCount, void *apvValues[]) {
+    Binding *pBinding;
+    size_t uFound = 0;
+    size_t i;
+    
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL);
+    assert(apvValues != NULL);
+    
+    /* Every search walks the same list, so there are no separate misses
+     * to overlap */
+    for (i = 0; i < uCount; i++) {
+        assert(apcKeys[i] != NULL);
+        pBinding = SymTable_findBinding(oSymTable, apcKeys[i]);
+        apvValues[i] = pBinding != NULL ? (void *)pBinding->pvValue : NULL;
+        uFound += pBinding != NULL;
+    }
+    
+    return uFound;
+}
+
+static size_t SymTable_doGetManyInterleaved(SymTable_T oSymTable,
+                                            const char *apcKeys[],
+                                            size_t uCount, void *apvValues[],
+                                            size_t uWidth) {
+    assert(uWidth >= 1 && uWidth <= SYMTABLE_MAX_INTERLEAVE);
+    (void)uWidth;
+    
+    return SymTable_doGetMany(oSymTable, apcKeys, uCount, apvValues);
+}
+
+static size_t SymTable_doPutMany(SymTable_T oSymTable, const char *apcKeys[],
+                                 const void *apvValues[], size_t uCount,
+                                 int aiAdded[]) {
+    size_t uAdded = 0;
+    size_t i;
+    int iAdded;
+    
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL);
+    assert(apvValues != NULL);
+    
+    /* A list never resizes, so there is nothing to decide up front */
+    for (i = 0; i < uCount; i++) {
+        assert(apcKeys[i] != NULL);
+        iAdded = SymTable_findBinding(oSymTable, apcKeys[i]) == NULL &&
+                 SymTable_insert(oSymTable, apcKeys[i], apvValues[i]) != NULL;
+        if (aiAdded != NULL)
+            aiAdded[i] = iAdded;
+        uAdded += (size_t)iAdded;
+    }
+    
+    return uAdded;
+}
+
+static void SymTable_doMapParallel(SymTable_T oSymTable,
+                                   void (*pfApply)(const char *pcKey,
+                                                   void *pvValue,
+                                                   void *pvExtra),
+                                   const void *pvExtra, size_t uThreads) {
+    assert(uThreads >= 1);
+    (void)uThreads;
+    
+    /* Splitting a list among threads would take a walk of its own, as
+     * long as the one that map makes, so one thread does it all */
+    SymTable_doMap(oSymTable, pfApply, pvExtra);
+}
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+    int iResult;
+    
+    TRACE_START();
+    iResult = SymTable_doReserve(oSymTable, uCapacity);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_RESERVE);
+    return iResult;
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+    size_t uLength;
+    
+    TRACE_START();
+    uLength = SymTable_doGetLength(oSymTable);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_LENGTH);
+    return uLength;
+}
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    int iResult;
+    
+    TRACE_START();
+    iResult = SymTable_doPut(oSymTable, pcKey, pvValue);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_PUT);
+    return iResult;
+}
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    void *pvOld;
+    
+    TRACE_START();
+    pvOld = SymTable_doReplace(oSymTable, pcKey, pvValue);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_REPLACE);
+    return pvOld;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    int iResult;
+    
+    TRACE_START();
+    iResult = SymTable_doContains(oSymTable, pcKey);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_CONTAINS);
+    return iResult;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    void *pvValue;
+    
+    TRACE_START();
+    pvValue = SymTable_doGet(oSymTable, pcKey);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET);
+    return pvValue;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    void *pvValue;
+    
+    TRACE_START();
+    pvValue = SymTable_doRemove(oSymTable, pcKey);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_REMOVE);
+    return pvValue;
+}
+
+void SymTable_map(SymTable_T oSymTable,
+                  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                  const void *pvExtra) {
+    TRACE_START();
+    SymTable_doMap(oSymTable, pfApply, pvExtra);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_MAP);
+}
+
+int SymTable_upsert(SymTable_T oSymTable, const char *pcKey, const void *pvValue,
+                    void **ppvOldValue) {
+    int iResult;
+    
+    TRACE_START();
+    iResult = SymTable_doUpsert(oSymTable, pcKey, pvValue, ppvOldValue);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_UPSERT);
+    return iResult;
+}
+
+void *SymTable_getOrPut(SymTable_T oSymTable, const char *pcKey,
+                        const void *pvValue, int *piAdded) {
+    void *pvResult;
+    
+    TRACE_START();
+    pvResult = SymTable_doGetOrPut(oSymTable, pcKey, pvValue, piAdded);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_OR_PUT);
+    return pvResult;
+}
+
+void *SymTable_getFound(SymTable_T oSymTable, const char *pcKey, int *piFound) {
+    void *pvValue;
+    
+    TRACE_START();
+    pvValue = SymTable_doGetFound(oSymTable, pcKey, piFound);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_FOUND);
+    return pvValue;
+}
+
+void **SymTable_entry(SymTable_T oSymTable, const char *pcKey, int *piCreated) {
+    void **ppvValue;
+    
+    TRACE_START();
+    ppvValue = SymTable_doEntry(oSymTable, pcKey, piCreated);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_ENTRY);
+    return ppvValue;
+}
+
+size_t SymTable_getMany(SymTable_T oSymTable, const char *apcKeys[],
+                        size_t uCount, void *apvValues[]) {
+    size_t uFound;
+    
+    TRACE_START();
+    uFound = SymTable_doGetMany(oSymTable, apcKeys, uCount, apvValues);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_MANY);
+    return uFound;
+}
+
+size_t SymTable_getManyInterleaved(SymTable_T oSymTable, const char *apcKeys[],
+                                   size_t uCount, void *apvValues[],
+                                   size_t uWidth) {
+    size_t uFound;
+    
+    TRACE_START();
+    uFound = SymTable_doGetManyInterleaved(oSymTable, apcKeys, uCount,
+                                           apvValues, uWidth);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_MANY_INTERLEAVED);
+    return uFound;
+}
+
+size_t SymTable_putMany(SymTable_T oSymTable, const char *apcKeys[],
+                        const void *apvValues[], size_t uCount, int aiAdded[]) {
+    size_t uAdded;
+    
+    TRACE_START();
+    uAdded = SymTable_doPutMany(oSymTable, apcKeys, apvValues, uCount,
+                                aiAdded);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_PUT_MANY);
+    return uAdded;
+}
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+                          void (*pfApply)(const char *pcKey, void *pvValue,
+                                          void *pvExtra),
+                          const void *pvExtra, size_t uThreads) {
+    TRACE_START();
+    SymTable_doMapParallel(oSymTable, pfApply, pvExtra, uThreads);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_MAP_PARALLEL);
+}
+
+/* Iterators are not timed by -DSYMTABLE_TRACE: a call of
+ * SymTable_iterNext costs less than reading the clock. */
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable) {
+    SymTableIter_T oIter;
+    
+    assert(oSymTable != NULL);
+    
+    oIter = oSymTable->pfAlloc(sizeof(struct SymTableIter),
+                               oSymTable->pvAllocExtra);
+    if (oIter == NULL)
+        return NULL;
+    
+    oIter->oSymTable = oSymTable;
+    oIter->pNext = oSymTable->pHead;
+    
+    return oIter;
+}
+
+int SymTable_iterNext(SymTableIter_T oIter, const char **ppcKey,
+                      void **ppvValue) {
+    Binding *pBinding;
+    
+    assert(oIter != NULL);
+    
+    pBinding = oIter->pNext;
+    if (pBinding == NULL)
+        return 0;
+    oIter->pNext = pBinding->pNext;
+    
+    if (ppcKey != NULL)
+        *ppcKey = pBinding->acKey;
+    if (ppvValue != NULL)
+        *ppvValue = (void *)pBinding->pvValue;
+    return 1;
+}
+
+void SymTable_iterEnd(SymTableIter_T oIter) {
+    assert(oIter != NULL);
+    
+    oIter->oSymTable->pfFree(oIter, sizeof(struct SymTableIter),
+                             oIter->oSymTable->pvAllocExtra);
+}
+
+int SymTable_getStats(SymTable_T oSymTable, SymTable_Stats *psStats) {
+    size_t uChainLength;
+    
+    assert(oSymTable != NULL);
+    assert(psStats != NULL);
+    
+    /* The whole list is a single bucket that never resizes */
+    memset(psStats, 0, sizeof(*psStats));
+    psStats->uLength = oSymTable->uLength;
+    psStats->uBucketCount = 1;
+    psStats->uMaxChainLength = oSymTable->uLength;
+    psStats->dMeanChainLength = (double)oSymTable->uLength;
+    TRACE_STATS(oSymTable, psStats);
+    
+    uChainLength = oSymTable->uLength;
+    if (uChainLength == 0)
+        psStats->uEmptyBuckets = 1;
+    if (uChainLength > SYMTABLE_HISTOGRAM_SIZE - 1)
+        uChainLength = SYMTABLE_HISTOGRAM_SIZE - 1;
+    psStats->auChainLengths[uChainLength] = 1;
+    
+    return 1;
+}
+
+int SymTable_getLatencyHistogram(SymTable_T oSymTable, enum SymTable_Op eOp,
+                                 unsigned long aulCounts[]) {
+    assert(oSymTable != NULL);
+    assert(eOp < SYMTABLE_OP_COUNT);
+    assert(aulCounts != NULL);
+    
+#ifdef SYMTABLE_TRACE
+    memcpy(aulCounts, oSymTable->aaulLatencies[eOp],
+           sizeof(oSymTable->aaulLatencies[eOp]));
+    return 1;
+#else
+    (void)oSymTable;
+    (void)eOp;
+    (void)aulCounts;
+    return 0;
+#endif
+}
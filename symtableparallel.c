@@ -0,0 +1,73 @@
+/* Author: Nicholas Budny */
+
+/* symtableparallel.c - Implementation of the thread splitting shared by
+ * the SymTable implementations */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <pthread.h>
+#include "symtableparallel.h"
+
+/* Most threads used by one call of Parallel_forRanges. Thread handles
+ * live on the stack, so that SymTable_mapParallel allocates nothing
+ * that a table's allocator does not provide. */
+enum { MAX_THREADS = 256 };
+
+/* A Range structure is the work of one thread: a call of pfRange */
+typedef struct Range {
+    size_t uStart;
+    size_t uEnd;
+    void (*pfRange)(size_t uStart, size_t uEnd, void *pvRangeExtra);
+    void *pvRangeExtra;
+} Range;
+
+/* Thread entry point: makes the call described by pvRange, a Range */
+static void *Parallel_run(void *pvRange) {
+    Range *psRange = pvRange;
+
+    psRange->pfRange(psRange->uStart, psRange->uEnd, psRange->pvRangeExtra);
+    return NULL;
+}
+
+void Parallel_forRanges(size_t uCount, size_t uThreads,
+                        void (*pfRange)(size_t uStart, size_t uEnd,
+                                        void *pvRangeExtra),
+                        void *pvRangeExtra) {
+    pthread_t aThreads[MAX_THREADS];
+    int aiStarted[MAX_THREADS];
+    Range asRanges[MAX_THREADS];
+    size_t i;
+
+    assert(pfRange != NULL);
+    assert(uThreads >= 1);
+
+    /* No thread gets an empty range */
+    if (uThreads > MAX_THREADS)
+        uThreads = MAX_THREADS;
+    if (uThreads > uCount)
+        uThreads = uCount > 0 ? uCount : 1;
+
+    for (i = 0; i < uThreads; i++) {
+        asRanges[i].uStart = uCount / uThreads * i +
+                             (i < uCount % uThreads ? i : uCount % uThreads);
+        asRanges[i].uEnd = asRanges[i].uStart + uCount / uThreads +
+                           (i < uCount % uThreads);
+        asRanges[i].pfRange = pfRange;
+        asRanges[i].pvRangeExtra = pvRangeExtra;
+    }
+
+    /* Range 0 is left for the calling thread */
+    for (i = 1; i < uThreads; i++)
+        aiStarted[i] = pthread_create(&aThreads[i], NULL, Parallel_run,
+                                      &asRanges[i]) == 0;
+
+    Parallel_run(&asRanges[0]);
+
+    for (i = 1; i < uThreads; i++) {
+        if (aiStarted[i])
+            pthread_join(aThreads[i], NULL);
+        else
+            Parallel_run(&asRanges[i]);
+    }
+}
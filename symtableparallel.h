@@ -0,0 +1,23 @@
+/* Author: Nicholas Budny */
+
+/* symtableparallel.h - Splitting work over threads, shared by the
+ * SymTable implementations for SymTable_mapParallel */
+
+#ifndef SYMTABLEPARALLEL_H
+#define SYMTABLEPARALLEL_H
+
+#include <stddef.h>
+
+/* Splits the indexes 0 to uCount - 1 into up to uThreads ranges of
+ * nearly equal length and calls pfRange(uStart, uEnd, pvRangeExtra) for
+ * each range [uStart, uEnd), each call on its own thread. The calling
+ * thread makes one of the calls, and also makes any call whose thread
+ * cannot be created. Returns once every call has returned.
+ * pfRange must not be NULL, and uThreads must be at least 1.
+ */
+void Parallel_forRanges(size_t uCount, size_t uThreads,
+                        void (*pfRange)(size_t uStart, size_t uEnd,
+                                        void *pvRangeExtra),
+                        void *pvRangeExtra);
+
+#endif
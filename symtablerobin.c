@@ -0,0 +1,1179 @@
+/* Author: Nicholas Budny */
+
+/* symtablerobin.c - Implementation of the SymTable ADT using an
+ * open-addressing hash table with Robin Hood probing */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symtablearena.h"
+#include "symtablehashfn.h"
+#include "symtableparallel.h"
+#include "symtabletrace.h"
+
+/* Initial number of slots; must be a power of two */
+static const size_t INITIAL_SLOT_COUNT = 512;
+
+/* Returned by SymTable_insert when it fails; never a slot index */
+static const size_t INSERT_FAILED = (size_t)-1;
+
+/* Number of keys whose searches SymTable_getMany overlaps */
+enum { GET_MANY_BATCH = 16 };
+
+/* Starts loading the cache line holding pv, where the compiler can */
+#ifdef __GNUC__
+#define PREFETCH(pv) __builtin_prefetch(pv)
+#else
+#define PREFETCH(pv) ((void)(pv))
+#endif
+
+/* A Slot holds one binding inline in the flat slot array.
+ * A slot whose pcKey is NULL is empty.
+ */
+typedef struct Slot {
+    /* Full hash of the key, cached so probes and growth skip rehashing */
+    size_t uHash;
+    /* Defensive copy of the key string, or NULL if the slot is empty */
+    char *pcKey;
+    /* Value associated with the key (client-owned) */
+    const void *pvValue;
+} Slot;
+
+/* The SymTable structure represents the entire hash table.
+ * It maintains the flat slot array and its size info.
+ */
+struct SymTable {
+    /* Array of slots */
+    Slot *pSlots;
+    /* Current number of slots (always a power of two) */
+    size_t uSlotCount;
+    /* Number of bindings (occupied slots) */
+    size_t uLength;
+    /* Hash function for keys, or NULL for the assignment hash */
+    size_t (*pfHash)(const char *pcKey, size_t uKeyLength,
+                     const void *pvHashExtra);
+    /* Context passed to pfHash */
+    const void *pvHashExtra;
+    /* Key of the hash of a table made by SymTable_newSeeded */
+    unsigned long long aullSeed[2];
+    /* Arena that key copies are allocated from, or NULL to use pfAlloc */
+    Arena_T oArena;
+    /* Allocation functions for the table, its slots and key copies */
+    void *(*pfAlloc)(size_t uSize, void *pvAllocExtra);
+    void (*pfFree)(void *pvBlock, size_t uSize, void *pvAllocExtra);
+    /* Context passed to pfAlloc and pfFree */
+    void *pvAllocExtra;
+    /* Number of rehashes that grew and that shrank the slot array */
+    size_t uExpansions;
+    size_t uShrinks;
+    /* Latency histograms and search counts, when built with
+     * -DSYMTABLE_TRACE */
+    TRACE_MEMBERS
+};
+
+/* A SymTableIter structure is a position in the slots of a table. */
+struct SymTableIter {
+    /* Table being iterated over */
+    SymTable_T oSymTable;
+    /* Index of the next slot to examine */
+    size_t uNextSlot;
+};
+
+/* Computes the full hash value for pcKey in oSymTable.
+ * Uses the table's hash function, or else the hash function specified
+ * in the assignment, without the final reduction.
+ * oSymTable and pcKey must not be NULL.
+ */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey) {
+    const size_t HASH_MULTIPLIER = 65599;
+    size_t uHash = 0;
+    size_t u;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    if (oSymTable->pfHash != NULL)
+        return oSymTable->pfHash(pcKey, strlen(pcKey), oSymTable->pvHashExtra);
+
+    for (u = 0; pcKey[u] != '\0'; u++)
+        uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+
+    return uHash;
+}
+
+/* Allocates uSize bytes with malloc; the allocator of tables created
+ * without one of their own */
+static void *SymTable_defaultAlloc(size_t uSize, void *pvAllocExtra) {
+    (void)pvAllocExtra;
+    return malloc(uSize);
+}
+
+/* Frees pvBlock with free; the counterpart of SymTable_defaultAlloc */
+static void SymTable_defaultFree(void *pvBlock, size_t uSize,
+                                 void *pvAllocExtra) {
+    (void)uSize;
+    (void)pvAllocExtra;
+    free(pvBlock);
+}
+
+/* Allocates an array of uSlotCount empty slots with the allocator of
+ * oSymTable.
+ * Returns NULL if insufficient memory is available.
+ * oSymTable must not be NULL.
+ */
+static Slot *SymTable_allocSlots(SymTable_T oSymTable, size_t uSlotCount) {
+    Slot *pSlots;
+    size_t i;
+
+    assert(oSymTable != NULL);
+
+    if (uSlotCount > (size_t)-1 / sizeof(Slot))
+        return NULL;
+
+    /* calloc leaves every pcKey NULL, marking all slots empty */
+    if (oSymTable->pfAlloc == SymTable_defaultAlloc)
+        return calloc(uSlotCount, sizeof(Slot));
+
+    pSlots = oSymTable->pfAlloc(uSlotCount * sizeof(Slot),
+                                oSymTable->pvAllocExtra);
+    if (pSlots == NULL)
+        return NULL;
+    for (i = 0; i < uSlotCount; i++)
+        pSlots[i].pcKey = NULL;
+
+    return pSlots;
+}
+
+/* Frees pSlots, an array of uSlotCount slots allocated by
+ * SymTable_allocSlots, but not the key copies in it.
+ * oSymTable and pSlots must not be NULL.
+ */
+static void SymTable_freeSlots(SymTable_T oSymTable, Slot *pSlots,
+                               size_t uSlotCount) {
+    assert(oSymTable != NULL);
+    assert(pSlots != NULL);
+
+    oSymTable->pfFree(pSlots, uSlotCount * sizeof(Slot),
+                      oSymTable->pvAllocExtra);
+}
+
+/* Returns a defensive copy of pcKey, allocated from the arena of
+ * oSymTable or else with its allocator.
+ * Returns NULL if insufficient memory is available.
+ * oSymTable and pcKey must not be NULL.
+ */
+static char *SymTable_copyKey(SymTable_T oSymTable, const char *pcKey) {
+    size_t uKeySize;
+    char *pcCopy;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uKeySize = strlen(pcKey) + 1;
+    if (oSymTable->oArena != NULL)
+        pcCopy = Arena_alloc(oSymTable->oArena, uKeySize);
+    else
+        pcCopy = oSymTable->pfAlloc(uKeySize, oSymTable->pvAllocExtra);
+
+    if (pcCopy != NULL)
+        memcpy(pcCopy, pcKey, uKeySize);
+    return pcCopy;
+}
+
+/* Frees pcKey, a key copy made by SymTable_copyKey. An arena keeps the
+ * bytes on a free list for reuse.
+ * oSymTable and pcKey must not be NULL.
+ */
+static void SymTable_freeKey(SymTable_T oSymTable, char *pcKey) {
+    size_t uKeySize;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uKeySize = strlen(pcKey) + 1;
+    if (oSymTable->oArena != NULL)
+        Arena_release(oSymTable->oArena, pcKey, uKeySize);
+    else
+        oSymTable->pfFree(pcKey, uKeySize, oSymTable->pvAllocExtra);
+}
+
+/* Returns the home slot of a key with hash uHash in a table of
+ * uSlotCount slots. The hash is mixed first because the assignment hash
+ * leaves its low bits poorly distributed, and a power-of-two mask only
+ * looks at the low bits.
+ */
+static size_t SymTable_home(size_t uHash, size_t uSlotCount) {
+    unsigned long long ullMixed = (unsigned long long)uHash;
+
+    ullMixed ^= ullMixed >> 33;
+    ullMixed *= 0xff51afd7ed558ccdULL;
+    ullMixed ^= ullMixed >> 33;
+
+    return (size_t)ullMixed & (uSlotCount - 1);
+}
+
+/* Returns how far the binding in slot uIndex sits from its home slot.
+ * The slot must be occupied.
+ */
+static size_t SymTable_distance(SymTable_T oSymTable, size_t uIndex) {
+    size_t uHome;
+
+    assert(oSymTable->pSlots[uIndex].pcKey != NULL);
+
+    uHome = SymTable_home(oSymTable->pSlots[uIndex].uHash,
+                          oSymTable->uSlotCount);
+    return (uIndex - uHome) & (oSymTable->uSlotCount - 1);
+}
+
+/* Returns the index of the slot holding pcKey (whose hash is uHash),
+ * or uSlotCount if pcKey is not in oSymTable.
+ * A Robin Hood probe can stop as soon as it passes a binding that is
+ * closer to its own home than pcKey would be at that position.
+ */
+static size_t SymTable_find(SymTable_T oSymTable, const char *pcKey,
+                            size_t uHash) {
+    size_t uMask = oSymTable->uSlotCount - 1;
+    size_t uIndex = SymTable_home(uHash, oSymTable->uSlotCount);
+    size_t uDist;
+    Slot *pSlot;
+
+    for (uDist = 0; ; uDist++) {
+        TRACE_PROBE(oSymTable);
+        pSlot = &oSymTable->pSlots[uIndex];
+        if (pSlot->pcKey == NULL ||
+            SymTable_distance(oSymTable, uIndex) < uDist)
+            return oSymTable->uSlotCount;
+        if (pSlot->uHash == uHash) {
+            TRACE_KEY_COMPARE(oSymTable);
+            if (strcmp(pSlot->pcKey, pcKey) == 0)
+                return uIndex;
+        }
+        uIndex = (uIndex + 1) & uMask;
+    }
+}
+
+/* Places a binding into the slot array of oSymTable, displacing
+ * richer bindings along the way, and returns the index of the slot it
+ * lands in. The key must not already be present and there must be at
+ * least one empty slot.
+ */
+static size_t SymTable_place(SymTable_T oSymTable, Slot sNew) {
+    size_t uMask = oSymTable->uSlotCount - 1;
+    size_t uIndex = SymTable_home(sNew.uHash, oSymTable->uSlotCount);
+    size_t uDist = 0;
+    size_t uPlaced = oSymTable->uSlotCount;
+    size_t uExisting;
+    Slot sTemp;
+
+    for (;;) {
+        if (oSymTable->pSlots[uIndex].pcKey == NULL) {
+            oSymTable->pSlots[uIndex] = sNew;
+            return uPlaced != oSymTable->uSlotCount ? uPlaced : uIndex;
+        }
+
+        /* Take from the rich: swap with a binding nearer its home */
+        uExisting = SymTable_distance(oSymTable, uIndex);
+        if (uExisting < uDist) {
+            sTemp = oSymTable->pSlots[uIndex];
+            oSymTable->pSlots[uIndex] = sNew;
+            sNew = sTemp;
+            uDist = uExisting;
+
+            /* The binding being placed stays where it first lands */
+            if (uPlaced == oSymTable->uSlotCount)
+                uPlaced = uIndex;
+        }
+
+        uIndex = (uIndex + 1) & uMask;
+        uDist++;
+    }
+}
+
+/* Returns the smallest power-of-two slot count, no smaller than
+ * INITIAL_SLOT_COUNT, that holds uCapacity bindings within the maximum
+ * load factor of 7/8, or 0 if no such count fits in a size_t.
+ */
+static size_t SymTable_slotsFor(size_t uCapacity) {
+    size_t uSlotCount = INITIAL_SLOT_COUNT;
+
+    while (uCapacity > uSlotCount / 8 * 7) {
+        if (uSlotCount > (size_t)-1 / 2 / sizeof(Slot))
+            return 0;
+        uSlotCount *= 2;
+    }
+
+    return uSlotCount;
+}
+
+/* Moves every binding of oSymTable into a new array of uSlotCount slots.
+ * Returns 1 if successful, 0 if memory allocation fails.
+ * oSymTable must not be NULL.
+ */
+static int SymTable_rehash(SymTable_T oSymTable, size_t uSlotCount) {
+    Slot *pOldSlots;
+    size_t uOldCount;
+    size_t i;
+
+    assert(oSymTable != NULL);
+
+    pOldSlots = oSymTable->pSlots;
+    uOldCount = oSymTable->uSlotCount;
+
+    oSymTable->pSlots = SymTable_allocSlots(oSymTable, uSlotCount);
+    if (oSymTable->pSlots == NULL) {
+        oSymTable->pSlots = pOldSlots;
+        return 0;
+    }
+    oSymTable->uSlotCount = uSlotCount;
+    if (uSlotCount > uOldCount)
+        oSymTable->uExpansions++;
+    else if (uSlotCount < uOldCount)
+        oSymTable->uShrinks++;
+
+    /* Reinsert using the cached hashes */
+    for (i = 0; i < uOldCount; i++) {
+        if (pOldSlots[i].pcKey != NULL)
+            SymTable_place(oSymTable, pOldSlots[i]);
+    }
+
+    SymTable_freeSlots(oSymTable, pOldSlots, uOldCount);
+    return 1;
+}
+
+/* Creates and returns a new empty table sized for uCapacity bindings,
+ * whose memory comes from pfAlloc and goes back through pfFree.
+ * Returns NULL if insufficient memory is available.
+ * pfAlloc and pfFree must not be NULL.
+ */
+static SymTable_T SymTable_create(
+    size_t uCapacity,
+    void *(*pfAlloc)(size_t uSize, void *pvAllocExtra),
+    void (*pfFree)(void *pvBlock, size_t uSize, void *pvAllocExtra),
+    void *pvAllocExtra) {
+    SymTable_T oSymTable;
+
+    assert(pfAlloc != NULL);
+    assert(pfFree != NULL);
+
+    oSymTable = pfAlloc(sizeof(struct SymTable), pvAllocExtra);
+    if (oSymTable == NULL)
+        return NULL;
+
+    oSymTable->uSlotCount = SymTable_slotsFor(uCapacity);
+    oSymTable->uLength = 0;
+    oSymTable->oArena = NULL;
+    oSymTable->pfHash = NULL;
+    oSymTable->pvHashExtra = NULL;
+    oSymTable->pfAlloc = pfAlloc;
+    oSymTable->pfFree = pfFree;
+    oSymTable->pvAllocExtra = pvAllocExtra;
+    oSymTable->uExpansions = 0;
+    oSymTable->uShrinks = 0;
+    TRACE_INIT(oSymTable);
+    if (oSymTable->uSlotCount == 0) {
+        pfFree(oSymTable, sizeof(struct SymTable), pvAllocExtra);
+        return NULL;
+    }
+
+    oSymTable->pSlots = SymTable_allocSlots(oSymTable, oSymTable->uSlotCount);
+    if (oSymTable->pSlots == NULL) {
+        pfFree(oSymTable, sizeof(struct SymTable), pvAllocExtra);
+        return NULL;
+    }
+
+    return oSymTable;
+}
+
+SymTable_T SymTable_new(void) {
+    return SymTable_newWithCapacity(0);
+}
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+    return SymTable_create(uCapacity, SymTable_defaultAlloc,
+                           SymTable_defaultFree, NULL);
+}
+
+SymTable_T SymTable_newWithAllocator(
+    void *(*pfAlloc)(size_t uSize, void *pvAllocExtra),
+    void (*pfFree)(void *pvBlock, size_t uSize, void *pvAllocExtra),
+    void *pvAllocExtra) {
+    return SymTable_create(0, pfAlloc, pfFree, pvAllocExtra);
+}
+
+SymTable_T SymTable_newWithHash(
+    size_t (*pfHash)(const char *pcKey, size_t uKeyLength,
+                     const void *pvHashExtra),
+    const void *pvHashExtra) {
+    SymTable_T oSymTable;
+
+    assert(pfHash != NULL);
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+        return NULL;
+
+    oSymTable->pfHash = pfHash;
+    oSymTable->pvHashExtra = pvHashExtra;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newSeeded(void) {
+    SymTable_T oSymTable;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+        return NULL;
+
+    /* The hash key lives in the table and is freed with it */
+    HashFn_randomSeed(oSymTable->aullSeed);
+    oSymTable->pfHash = SymTable_hashSiphash13;
+    oSymTable->pvHashExtra = oSymTable->aullSeed;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newArena(void) {
+    SymTable_T oSymTable;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+        return NULL;
+
+    /* Key copies come from the arena from the first put on */
+    oSymTable->oArena = Arena_new();
+    if (oSymTable->oArena == NULL) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+
+    return oSymTable;
+}
+
+void SymTable_free(SymTable_T oSymTable) {
+    size_t i;
+
+    assert(oSymTable != NULL);
+
+    /* Free the key copies of occupied slots, or all at once from the arena */
+    if (oSymTable->oArena != NULL)
+        Arena_free(oSymTable->oArena);
+    else {
+        for (i = 0; i < oSymTable->uSlotCount; i++) {
+            if (oSymTable->pSlots[i].pcKey != NULL)
+                SymTable_freeKey(oSymTable, oSymTable->pSlots[i].pcKey);
+        }
+    }
+
+    SymTable_freeSlots(oSymTable, oSymTable->pSlots, oSymTable->uSlotCount);
+    oSymTable->pfFree(oSymTable, sizeof(struct SymTable),
+                      oSymTable->pvAllocExtra);
+}
+
+/* Adds a binding of pcKey, whose hash is uHash, to pvValue, growing the
+ * slot array first if the binding would push the load factor above 7/8.
+ * pcKey must not be in the table already.
+ * Returns the index of the slot holding the new binding, or INSERT_FAILED
+ * if insufficient memory is available.
+ * oSymTable and pcKey must not be NULL.
+ */
+static size_t SymTable_insert(SymTable_T oSymTable, const char *pcKey,
+                              size_t uHash, const void *pvValue) {
+    Slot sNew;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /* Keep the load factor at or below 7/8 so probe sequences stay short */
+    if ((oSymTable->uLength + 1) * 8 > oSymTable->uSlotCount * 7) {
+        if (!SymTable_rehash(oSymTable, oSymTable->uSlotCount * 2))
+            return INSERT_FAILED;
+    }
+
+    /* Create defensive copy of the key */
+    sNew.pcKey = SymTable_copyKey(oSymTable, pcKey);
+    if (sNew.pcKey == NULL)
+        return INSERT_FAILED;
+    sNew.uHash = uHash;
+
+    /* Store the value pointer (no defensive copy) */
+    sNew.pvValue = pvValue;
+
+    oSymTable->uLength++;
+    return SymTable_place(oSymTable, sNew);
+}
+
+/* Looks up apcKeys[0..uCount-1] as SymTable_getMany does, uBatchSize
+ * keys at a time: hashes a batch and prefetches where each of its probes
+ * begins, so that the probes find their first cache lines loaded.
+ * Returns the number of keys found.
+ */
+static size_t SymTable_getBatches(SymTable_T oSymTable, const char *apcKeys[],
+                                  size_t uCount, void *apvValues[],
+                                  size_t uBatchSize) {
+    size_t auHashes[SYMTABLE_MAX_INTERLEAVE];
+    const Slot *pSlot;
+    size_t uStart;
+    size_t uBatch;
+    size_t uIndex;
+    size_t uFound = 0;
+    size_t i;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL);
+    assert(apvValues != NULL);
+    assert(uBatchSize >= 1 && uBatchSize <= SYMTABLE_MAX_INTERLEAVE);
+
+    for (uStart = 0; uStart < uCount; uStart += uBatch) {
+        uBatch = uCount - uStart < uBatchSize ? uCount - uStart : uBatchSize;
+
+        /* Hash every key of the batch and start loading where its
+         * probe begins */
+        for (i = 0; i < uBatch; i++) {
+            assert(apcKeys[uStart + i] != NULL);
+            auHashes[i] = SymTable_hash(oSymTable, apcKeys[uStart + i]);
+            PREFETCH(&oSymTable->pSlots[SymTable_home(auHashes[i],
+                                                      oSymTable->uSlotCount)]);
+        }
+
+        /* By now the home slots have arrived: start loading the key of
+         * each one that may hold its key, for the comparison */
+        for (i = 0; i < uBatch; i++) {
+            pSlot = &oSymTable->pSlots[SymTable_home(auHashes[i],
+                                                     oSymTable->uSlotCount)];
+            if (pSlot->pcKey != NULL && pSlot->uHash == auHashes[i])
+                PREFETCH(pSlot->pcKey);
+        }
+
+        /* Then probe, mostly through lines that are already cached */
+        for (i = 0; i < uBatch; i++) {
+            uIndex = SymTable_find(oSymTable, apcKeys[uStart + i],
+                                   auHashes[i]);
+            if (uIndex == oSymTable->uSlotCount) {
+                apvValues[uStart + i] = NULL;
+                continue;
+            }
+            apvValues[uStart + i] = (void *)oSymTable->pSlots[uIndex].pvValue;
+            uFound++;
+        }
+    }
+
+    return uFound;
+}
+
+/* A MapJob structure holds the arguments of SymTable_mapParallel for
+ * each of its threads */
+typedef struct MapJob {
+    SymTable_T oSymTable;
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+    void *pvExtra;
+} MapJob;
+
+/* Applies the function of pvMapJob, a MapJob, to every binding in
+ * slots uStart to uEnd - 1 of its table.
+ */
+static void SymTable_mapRange(size_t uStart, size_t uEnd, void *pvMapJob) {
+    const MapJob *psJob = pvMapJob;
+    SymTable_T oSymTable = psJob->oSymTable;
+    size_t i;
+
+    for (i = uStart; i < uEnd; i++) {
+        if (oSymTable->pSlots[i].pcKey != NULL)
+            psJob->pfApply(oSymTable->pSlots[i].pcKey,
+                           (void *)oSymTable->pSlots[i].pvValue,
+                           psJob->pvExtra);
+    }
+}
+
+/* The operations of symtable.h, which the public functions below time
+ * when built with -DSYMTABLE_TRACE */
+
+static int SymTable_doReserve(SymTable_T oSymTable, size_t uCapacity) {
+    size_t uSlotCount;
+
+    assert(oSymTable != NULL);
+
+    uSlotCount = SymTable_slotsFor(uCapacity);
+    if (uSlotCount == 0)
+        return 0;
+
+    if (uSlotCount > oSymTable->uSlotCount)
+        return SymTable_rehash(oSymTable, uSlotCount);
+
+    return 1;
+}
+
+static size_t SymTable_doGetLength(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+
+    return oSymTable->uLength;
+}
+
+static int SymTable_doPut(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    size_t uHash;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hash(oSymTable, pcKey);
+
+    /* Check if key already exists */
+    if (SymTable_find(oSymTable, pcKey, uHash) != oSymTable->uSlotCount)
+        return 0;
+
+    return SymTable_insert(oSymTable, pcKey, uHash, pvValue) != INSERT_FAILED;
+}
+
+static void *SymTable_doReplace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    size_t uIndex;
+    const void *pvOld;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(oSymTable, pcKey));
+    if (uIndex == oSymTable->uSlotCount)
+        return NULL;
+
+    pvOld = oSymTable->pSlots[uIndex].pvValue;
+    oSymTable->pSlots[uIndex].pvValue = pvValue;
+
+    return (void *)pvOld;
+}
+
+static int SymTable_doContains(SymTable_T oSymTable, const char *pcKey) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    return SymTable_find(oSymTable, pcKey, SymTable_hash(oSymTable, pcKey))
+        != oSymTable->uSlotCount;
+}
+
+static void *SymTable_doGet(SymTable_T oSymTable, const char *pcKey) {
+    size_t uIndex;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(oSymTable, pcKey));
+    if (uIndex == oSymTable->uSlotCount)
+        return NULL;
+
+    return (void *)oSymTable->pSlots[uIndex].pvValue;
+}
+
+static void *SymTable_doRemove(SymTable_T oSymTable, const char *pcKey) {
+    size_t uMask;
+    size_t uIndex;
+    size_t uNext;
+    const void *pvValue;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(oSymTable, pcKey));
+    if (uIndex == oSymTable->uSlotCount)
+        return NULL;
+
+    /* Save the value to return and free the key copy */
+    pvValue = oSymTable->pSlots[uIndex].pvValue;
+    SymTable_freeKey(oSymTable, oSymTable->pSlots[uIndex].pcKey);
+
+    /* Backward-shift deletion: pull each following displaced binding
+     * one slot closer to its home, so no tombstones are needed */
+    uMask = oSymTable->uSlotCount - 1;
+    for (uNext = (uIndex + 1) & uMask;
+         oSymTable->pSlots[uNext].pcKey != NULL &&
+         SymTable_distance(oSymTable, uNext) > 0;
+         uNext = (uNext + 1) & uMask) {
+        oSymTable->pSlots[uIndex] = oSymTable->pSlots[uNext];
+        uIndex = uNext;
+    }
+    oSymTable->pSlots[uIndex].pcKey = NULL;
+
+    oSymTable->uLength--;
+
+    return (void *)pvValue;
+}
+
+static void SymTable_doMap(SymTable_T oSymTable,
+                           void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                           const void *pvExtra) {
+    size_t i;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    for (i = 0; i < oSymTable->uSlotCount; i++) {
+        if (oSymTable->pSlots[i].pcKey != NULL)
+            pfApply(oSymTable->pSlots[i].pcKey,
+                    (void *)oSymTable->pSlots[i].pvValue, (void *)pvExtra);
+    }
+}
+
+static int SymTable_doUpsert(SymTable_T oSymTable, const char *pcKey,
+                             const void *pvValue, void **ppvOldValue) {
+    size_t uHash;
+    size_t uIndex;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /* One hash and one probe, whatever the outcome */
+    uHash = SymTable_hash(oSymTable, pcKey);
+    uIndex = SymTable_find(oSymTable, pcKey, uHash);
+
+    if (uIndex != oSymTable->uSlotCount) {
+        if (ppvOldValue != NULL)
+            *ppvOldValue = (void *)oSymTable->pSlots[uIndex].pvValue;
+        oSymTable->pSlots[uIndex].pvValue = pvValue;
+        return 0;
+    }
+
+    if (SymTable_insert(oSymTable, pcKey, uHash, pvValue) == INSERT_FAILED)
+        return -1;
+    return 1;
+}
+
+static void *SymTable_doGetOrPut(SymTable_T oSymTable, const char *pcKey,
+                                 const void *pvValue, int *piAdded) {
+    size_t uHash;
+    size_t uIndex;
+    int iAdded = 0;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hash(oSymTable, pcKey);
+    uIndex = SymTable_find(oSymTable, pcKey, uHash);
+
+    if (uIndex == oSymTable->uSlotCount) {
+        uIndex = SymTable_insert(oSymTable, pcKey, uHash, pvValue);
+        iAdded = uIndex != INSERT_FAILED ? 1 : -1;
+    }
+
+    if (piAdded != NULL)
+        *piAdded = iAdded;
+    if (iAdded < 0)
+        return NULL;
+    return (void *)oSymTable->pSlots[uIndex].pvValue;
+}
+
+static void *SymTable_doGetFound(SymTable_T oSymTable, const char *pcKey,
+                                 int *piFound) {
+    size_t uIndex;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(piFound != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(oSymTable, pcKey));
+
+    *piFound = uIndex != oSymTable->uSlotCount;
+    if (uIndex == oSymTable->uSlotCount)
+        return NULL;
+    return (void *)oSymTable->pSlots[uIndex].pvValue;
+}
+
+static void **SymTable_doEntry(SymTable_T oSymTable, const char *pcKey,
+                               int *piCreated) {
+    size_t uHash;
+    size_t uIndex;
+    int iCreated = 0;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hash(oSymTable, pcKey);
+    uIndex = SymTable_find(oSymTable, pcKey, uHash);
+
+    if (uIndex == oSymTable->uSlotCount) {
+        uIndex = SymTable_insert(oSymTable, pcKey, uHash, NULL);
+        iCreated = uIndex != INSERT_FAILED;
+    }
+
+    if (piCreated != NULL)
+        *piCreated = iCreated;
+    if (uIndex == INSERT_FAILED)
+        return NULL;
+    return (void **)&oSymTable->pSlots[uIndex].pvValue;
+}
+
+static size_t SymTable_doGetMany(SymTable_T oSymTable, const char *apcKeys[],
+                                 size_t uCount, void *apvValues[]) {
+    return SymTable_getBatches(oSymTable, apcKeys, uCount, apvValues,
+                               GET_MANY_BATCH);
+}
+
+static size_t SymTable_doGetManyInterleaved(SymTable_T oSymTable,
+                                            const char *apcKeys[],
+                                            size_t uCount, void *apvValues[],
+                                            size_t uWidth) {
+    return SymTable_getBatches(oSymTable, apcKeys, uCount, apvValues, uWidth);
+}
+
+static size_t SymTable_doPutMany(SymTable_T oSymTable, const char *apcKeys[],
+                                 const void *apvValues[], size_t uCount,
+                                 int aiAdded[]) {
+    size_t auHashes[GET_MANY_BATCH];
+    size_t uStart;
+    size_t uBatch;
+    size_t uIndex;
+    size_t uAdded = 0;
+    size_t i;
+    int iAdded;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL);
+    assert(apvValues != NULL);
+
+    /* Grow once, straight to a size that holds every key, so that no
+     * insert below has to. If that fails, the inserts grow the table as
+     * they need to. */
+    if (uCount <= (size_t)-1 - oSymTable->uLength)
+        (void)SymTable_doReserve(oSymTable, oSymTable->uLength + uCount);
+
+    for (uStart = 0; uStart < uCount; uStart += uBatch) {
+        uBatch = uCount - uStart < GET_MANY_BATCH ? uCount - uStart
+                                                  : GET_MANY_BATCH;
+
+        /* Hash the batch in one tight loop, prefetching where each probe
+         * begins */
+        for (i = 0; i < uBatch; i++) {
+            assert(apcKeys[uStart + i] != NULL);
+            auHashes[i] = SymTable_hash(oSymTable, apcKeys[uStart + i]);
+            PREFETCH(&oSymTable->pSlots[SymTable_home(auHashes[i],
+                                                      oSymTable->uSlotCount)]);
+        }
+
+        for (i = 0; i < uBatch; i++) {
+            iAdded = 0;
+            if (SymTable_find(oSymTable, apcKeys[uStart + i], auHashes[i])
+                == oSymTable->uSlotCount) {
+                uIndex = SymTable_insert(oSymTable, apcKeys[uStart + i],
+                                         auHashes[i], apvValues[uStart + i]);
+                iAdded = uIndex != INSERT_FAILED;
+            }
+            if (aiAdded != NULL)
+                aiAdded[uStart + i] = iAdded;
+            uAdded += (size_t)iAdded;
+        }
+    }
+
+    return uAdded;
+}
+
+static void SymTable_doMapParallel(SymTable_T oSymTable,
+                                   void (*pfApply)(const char *pcKey,
+                                                   void *pvValue,
+                                                   void *pvExtra),
+                                   const void *pvExtra, size_t uThreads) {
+    MapJob sJob;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    assert(uThreads >= 1);
+
+    sJob.oSymTable = oSymTable;
+    sJob.pfApply = pfApply;
+    sJob.pvExtra = (void *)pvExtra;
+
+    Parallel_forRanges(oSymTable->uSlotCount, uThreads, SymTable_mapRange, &sJob);
+}
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+    int iResult;
+
+    TRACE_START();
+    iResult = SymTable_doReserve(oSymTable, uCapacity);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_RESERVE);
+    return iResult;
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+    size_t uLength;
+
+    TRACE_START();
+    uLength = SymTable_doGetLength(oSymTable);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_LENGTH);
+    return uLength;
+}
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    int iResult;
+
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    iResult = SymTable_doPut(oSymTable, pcKey, pvValue);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_PUT,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return iResult;
+}
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    void *pvOld;
+
+    TRACE_START();
+    pvOld = SymTable_doReplace(oSymTable, pcKey, pvValue);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_REPLACE);
+    return pvOld;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    int iResult;
+
+    TRACE_START();
+    iResult = SymTable_doContains(oSymTable, pcKey);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_CONTAINS);
+    return iResult;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    void *pvValue;
+
+    TRACE_START();
+    pvValue = SymTable_doGet(oSymTable, pcKey);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET);
+    return pvValue;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    void *pvValue;
+
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    pvValue = SymTable_doRemove(oSymTable, pcKey);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_REMOVE,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return pvValue;
+}
+
+void SymTable_map(SymTable_T oSymTable,
+                  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                  const void *pvExtra) {
+    TRACE_START();
+    SymTable_doMap(oSymTable, pfApply, pvExtra);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_MAP);
+}
+
+int SymTable_upsert(SymTable_T oSymTable, const char *pcKey, const void *pvValue,
+                    void **ppvOldValue) {
+    int iResult;
+
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    iResult = SymTable_doUpsert(oSymTable, pcKey, pvValue, ppvOldValue);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_UPSERT,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return iResult;
+}
+
+void *SymTable_getOrPut(SymTable_T oSymTable, const char *pcKey,
+                        const void *pvValue, int *piAdded) {
+    void *pvResult;
+
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    pvResult = SymTable_doGetOrPut(oSymTable, pcKey, pvValue, piAdded);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_GET_OR_PUT,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return pvResult;
+}
+
+void *SymTable_getFound(SymTable_T oSymTable, const char *pcKey, int *piFound) {
+    void *pvValue;
+
+    TRACE_START();
+    pvValue = SymTable_doGetFound(oSymTable, pcKey, piFound);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_FOUND);
+    return pvValue;
+}
+
+void **SymTable_entry(SymTable_T oSymTable, const char *pcKey, int *piCreated) {
+    void **ppvValue;
+
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    ppvValue = SymTable_doEntry(oSymTable, pcKey, piCreated);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_ENTRY,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return ppvValue;
+}
+
+size_t SymTable_getMany(SymTable_T oSymTable, const char *apcKeys[],
+                        size_t uCount, void *apvValues[]) {
+    size_t uFound;
+
+    TRACE_START();
+    uFound = SymTable_doGetMany(oSymTable, apcKeys, uCount, apvValues);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_MANY);
+    return uFound;
+}
+
+size_t SymTable_getManyInterleaved(SymTable_T oSymTable, const char *apcKeys[],
+                                   size_t uCount, void *apvValues[],
+                                   size_t uWidth) {
+    size_t uFound;
+
+    TRACE_START();
+    uFound = SymTable_doGetManyInterleaved(oSymTable, apcKeys, uCount,
+                                           apvValues, uWidth);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_MANY_INTERLEAVED);
+    return uFound;
+}
+
+size_t SymTable_putMany(SymTable_T oSymTable, const char *apcKeys[],
+                        const void *apvValues[], size_t uCount, int aiAdded[]) {
+    size_t uAdded;
+
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    uAdded = SymTable_doPutMany(oSymTable, apcKeys, apvValues, uCount,
+                                aiAdded);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_PUT_MANY,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return uAdded;
+}
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+                          void (*pfApply)(const char *pcKey, void *pvValue,
+                                          void *pvExtra),
+                          const void *pvExtra, size_t uThreads) {
+    TRACE_START();
+    SymTable_doMapParallel(oSymTable, pfApply, pvExtra, uThreads);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_MAP_PARALLEL);
+}
+
+/* Iterators are not timed by -DSYMTABLE_TRACE: a call of
+ * SymTable_iterNext costs less than reading the clock. */
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable) {
+    SymTableIter_T oIter;
+
+    assert(oSymTable != NULL);
+
+    oIter = oSymTable->pfAlloc(sizeof(struct SymTableIter),
+                               oSymTable->pvAllocExtra);
+    if (oIter == NULL)
+        return NULL;
+
+    oIter->oSymTable = oSymTable;
+    oIter->uNextSlot = 0;
+
+    return oIter;
+}
+
+int SymTable_iterNext(SymTableIter_T oIter, const char **ppcKey,
+                      void **ppvValue) {
+    SymTable_T oSymTable;
+    const Slot *pSlot;
+
+    assert(oIter != NULL);
+
+    /* Skip empty slots */
+    oSymTable = oIter->oSymTable;
+    while (oIter->uNextSlot < oSymTable->uSlotCount && oSymTable->pSlots[oIter->uNextSlot].pcKey == NULL)
+        oIter->uNextSlot++;
+    if (oIter->uNextSlot == oSymTable->uSlotCount)
+        return 0;
+
+    pSlot = &oSymTable->pSlots[oIter->uNextSlot++];
+    if (ppcKey != NULL)
+        *ppcKey = pSlot->pcKey;
+    if (ppvValue != NULL)
+        *ppvValue = (void *)pSlot->pvValue;
+    return 1;
+}
+
+void SymTable_iterEnd(SymTableIter_T oIter) {
+    assert(oIter != NULL);
+
+    oIter->oSymTable->pfFree(oIter, sizeof(struct SymTableIter),
+                             oIter->oSymTable->pvAllocExtra);
+}
+
+/* Adds a bucket whose chain holds uChainLength bindings to the chain
+ * counts of *psStats */
+static void SymTable_addChain(SymTable_Stats *psStats, size_t uChainLength) {
+    if (uChainLength == 0)
+        psStats->uEmptyBuckets++;
+    if (uChainLength > psStats->uMaxChainLength)
+        psStats->uMaxChainLength = uChainLength;
+
+    if (uChainLength > SYMTABLE_HISTOGRAM_SIZE - 1)
+        uChainLength = SYMTABLE_HISTOGRAM_SIZE - 1;
+    psStats->auChainLengths[uChainLength]++;
+}
+
+int SymTable_getStats(SymTable_T oSymTable, SymTable_Stats *psStats) {
+    size_t uMask;
+    size_t uStart;
+    size_t uHome = 0;
+    size_t uRunHome = 0;
+    size_t uRunLength = 0;
+    size_t uHomes = 0;
+    size_t uSlotCount;
+    Slot *pSlot;
+    size_t i;
+
+    assert(oSymTable != NULL);
+    assert(psStats != NULL);
+
+    memset(psStats, 0, sizeof(*psStats));
+    psStats->uLength = oSymTable->uLength;
+    psStats->uBucketCount = oSymTable->uSlotCount;
+    psStats->uExpansions = oSymTable->uExpansions;
+    psStats->uShrinks = oSymTable->uShrinks;
+    TRACE_STATS(oSymTable, psStats);
+    for (uSlotCount = INITIAL_SLOT_COUNT; uSlotCount < oSymTable->uSlotCount;
+         uSlotCount *= 2)
+        psStats->uGrowthStep++;
+
+    /* Robin Hood order keeps the bindings of each home slot adjacent,
+     * and the load limit guarantees an empty slot to start after */
+    uMask = oSymTable->uSlotCount - 1;
+    for (uStart = 0; oSymTable->pSlots[uStart].pcKey != NULL; uStart++)
+        ;
+
+    /* The last step returns to the empty start slot, ending any run */
+    for (i = 1; i <= oSymTable->uSlotCount; i++) {
+        pSlot = &oSymTable->pSlots[(uStart + i) & uMask];
+        if (pSlot->pcKey != NULL) {
+            uHome = SymTable_home(pSlot->uHash, oSymTable->uSlotCount);
+            if (uRunLength > 0 && uHome == uRunHome) {
+                uRunLength++;
+                continue;
+            }
+        }
+
+        if (uRunLength > 0) {
+            SymTable_addChain(psStats, uRunLength);
+            uHomes++;
+        }
+        uRunLength = 0;
+        if (pSlot->pcKey != NULL) {
+            uRunHome = uHome;
+            uRunLength = 1;
+        }
+    }
+
+    /* Every other slot is the home of no binding */
+    psStats->uEmptyBuckets += oSymTable->uSlotCount - uHomes;
+    psStats->auChainLengths[0] += oSymTable->uSlotCount - uHomes;
+
+    if (uHomes > 0)
+        psStats->dMeanChainLength = (double)psStats->uLength / (double)uHomes;
+
+    return 1;
+}
+
+int SymTable_getLatencyHistogram(SymTable_T oSymTable, enum SymTable_Op eOp,
+                                 unsigned long aulCounts[]) {
+    assert(oSymTable != NULL);
+    assert(eOp < SYMTABLE_OP_COUNT);
+    assert(aulCounts != NULL);
+
+#ifdef SYMTABLE_TRACE
+    memcpy(aulCounts, oSymTable->aaulLatencies[eOp],
+           sizeof(oSymTable->aaulLatencies[eOp]));
+    return 1;
+#else
+    (void)oSymTable;
+    (void)eOp;
+    (void)aulCounts;
+    return 0;
+#endif
+}
@@ -0,0 +1,1239 @@
+/* Author: Nicholas Budny */
+
+/* symtableswiss.c - Implementation of the SymTable ADT using an
+ * open-addressing "Swiss table": a control-byte array alongside the
+ * slot array, probed one 16-slot group at a time */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symtablearena.h"
+#include "symtablehashfn.h"
+#include "symtableparallel.h"
+#include "symtabletrace.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* Number of slots (and control bytes) probed together */
+enum { GROUP_WIDTH = 16 };
+
+/* Initial number of groups; must be a power of two */
+static const size_t INITIAL_GROUP_COUNT = 32;
+
+/* Control byte values. A full slot holds the 7-bit fingerprint of its
+ * key's hash (0..127), so only the special values have the sign bit set.
+ */
+static const signed char CTRL_EMPTY = -128;
+static const signed char CTRL_DELETED = -2;
+
+/* Returned by SymTable_insert when it fails; never a slot index */
+static const size_t INSERT_FAILED = (size_t)-1;
+
+/* Number of keys whose searches SymTable_getMany overlaps */
+enum { GET_MANY_BATCH = 16 };
+
+/* Starts loading the cache line holding pv, where the compiler can */
+#ifdef __GNUC__
+#define PREFETCH(pv) __builtin_prefetch(pv)
+#else
+#define PREFETCH(pv) ((void)(pv))
+#endif
+
+/* A Slot holds one binding. Whether it is in use is recorded only in
+ * the matching control byte.
+ */
+typedef struct Slot {
+    /* Full (mixed) hash of the key, cached so growth skips rehashing */
+    size_t uHash;
+    /* Defensive copy of the key string */
+    char *pcKey;
+    /* Value associated with the key (client-owned) */
+    const void *pvValue;
+} Slot;
+
+/* The SymTable structure represents the entire hash table.
+ * It maintains the control bytes, the slots, and counts.
+ */
+struct SymTable {
+    /* One control byte per slot */
+    signed char *pcCtrl;
+    /* Array of slots, parallel to pcCtrl */
+    Slot *pSlots;
+    /* Current number of groups (always a power of two) */
+    size_t uGroupCount;
+    /* Number of bindings (full slots) */
+    size_t uLength;
+    /* Number of slots marked CTRL_DELETED */
+    size_t uDeleted;
+    /* Hash function for keys, or NULL for the assignment hash */
+    size_t (*pfHash)(const char *pcKey, size_t uKeyLength,
+                     const void *pvHashExtra);
+    /* Context passed to pfHash */
+    const void *pvHashExtra;
+    /* Key of the hash of a table made by SymTable_newSeeded */
+    unsigned long long aullSeed[2];
+    /* Arena that key copies are allocated from, or NULL to use pfAlloc */
+    Arena_T oArena;
+    /* Allocation functions for the table, its groups and key copies */
+    void *(*pfAlloc)(size_t uSize, void *pvAllocExtra);
+    void (*pfFree)(void *pvBlock, size_t uSize, void *pvAllocExtra);
+    /* Context passed to pfAlloc and pfFree */
+    void *pvAllocExtra;
+    /* Number of rehashes that grew and that shrank the groups */
+    size_t uExpansions;
+    size_t uShrinks;
+    /* Latency histograms and search counts, when built with
+     * -DSYMTABLE_TRACE */
+    TRACE_MEMBERS
+};
+
+/* A SymTableIter structure is a position in the slots of a table. */
+struct SymTableIter {
+    /* Table being iterated over */
+    SymTable_T oSymTable;
+    /* Index of the next slot to examine */
+    size_t uNextSlot;
+};
+
+/* Computes the hash value for pcKey in oSymTable.
+ * Uses the table's hash function, or else the hash function specified in
+ * the assignment, followed by a mixing step: group selection uses the
+ * high bits and the fingerprint the low 7 bits, and the assignment hash
+ * alone distributes those poorly.
+ * oSymTable and pcKey must not be NULL.
+ */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey) {
+    const size_t HASH_MULTIPLIER = 65599;
+    size_t uHash = 0;
+    size_t u;
+    unsigned long long ullMixed;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    if (oSymTable->pfHash != NULL)
+        uHash = oSymTable->pfHash(pcKey, strlen(pcKey), oSymTable->pvHashExtra);
+    else {
+        for (u = 0; pcKey[u] != '\0'; u++)
+            uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+    }
+
+    ullMixed = (unsigned long long)uHash;
+    ullMixed ^= ullMixed >> 33;
+    ullMixed *= 0xff51afd7ed558ccdULL;
+    ullMixed ^= ullMixed >> 33;
+
+    return (size_t)ullMixed;
+}
+
+/* Allocates uSize bytes with malloc; the allocator of tables created
+ * without one of their own */
+static void *SymTable_defaultAlloc(size_t uSize, void *pvAllocExtra) {
+    (void)pvAllocExtra;
+    return malloc(uSize);
+}
+
+/* Frees pvBlock with free; the counterpart of SymTable_defaultAlloc */
+static void SymTable_defaultFree(void *pvBlock, size_t uSize,
+                                 void *pvAllocExtra) {
+    (void)uSize;
+    (void)pvAllocExtra;
+    free(pvBlock);
+}
+
+/* Returns a defensive copy of pcKey, allocated from the arena of
+ * oSymTable or else with its allocator.
+ * Returns NULL if insufficient memory is available.
+ * oSymTable and pcKey must not be NULL.
+ */
+static char *SymTable_copyKey(SymTable_T oSymTable, const char *pcKey) {
+    size_t uKeySize;
+    char *pcCopy;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uKeySize = strlen(pcKey) + 1;
+    if (oSymTable->oArena != NULL)
+        pcCopy = Arena_alloc(oSymTable->oArena, uKeySize);
+    else
+        pcCopy = oSymTable->pfAlloc(uKeySize, oSymTable->pvAllocExtra);
+
+    if (pcCopy != NULL)
+        memcpy(pcCopy, pcKey, uKeySize);
+    return pcCopy;
+}
+
+/* Frees pcKey, a key copy made by SymTable_copyKey. An arena keeps the
+ * bytes on a free list for reuse.
+ * oSymTable and pcKey must not be NULL.
+ */
+static void SymTable_freeKey(SymTable_T oSymTable, char *pcKey) {
+    size_t uKeySize;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uKeySize = strlen(pcKey) + 1;
+    if (oSymTable->oArena != NULL)
+        Arena_release(oSymTable->oArena, pcKey, uKeySize);
+    else
+        oSymTable->pfFree(pcKey, uKeySize, oSymTable->pvAllocExtra);
+}
+
+/* Returns the 7-bit fingerprint stored in the control byte for uHash */
+static signed char SymTable_fingerprint(size_t uHash) {
+    return (signed char)(uHash & 0x7F);
+}
+
+/* Returns the first group probed for uHash in a table of uGroupCount groups */
+static size_t SymTable_firstGroup(size_t uHash, size_t uGroupCount) {
+    return (uHash >> 7) & (uGroupCount - 1);
+}
+
+/* Returns a bit mask with bit i set iff pcGroup[i] == cByte, for the
+ * GROUP_WIDTH control bytes starting at pcGroup.
+ */
+static unsigned SymTable_matchByte(const signed char *pcGroup, signed char cByte) {
+#ifdef __SSE2__
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)(const void *)pcGroup);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(cByte)));
+#else
+    unsigned uMask = 0;
+    unsigned i;
+
+    for (i = 0; i < GROUP_WIDTH; i++) {
+        if (pcGroup[i] == cByte)
+            uMask |= 1u << i;
+    }
+    return uMask;
+#endif
+}
+
+/* Returns a bit mask with bit i set iff pcGroup[i] is CTRL_EMPTY or
+ * CTRL_DELETED, i.e. iff the slot is free for insertion.
+ */
+static unsigned SymTable_matchFree(const signed char *pcGroup) {
+#ifdef __SSE2__
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)(const void *)pcGroup);
+    /* Only the special values have their sign bit set */
+    return (unsigned)_mm_movemask_epi8(ctrl);
+#else
+    unsigned uMask = 0;
+    unsigned i;
+
+    for (i = 0; i < GROUP_WIDTH; i++) {
+        if (pcGroup[i] < 0)
+            uMask |= 1u << i;
+    }
+    return uMask;
+#endif
+}
+
+/* Returns the index of the lowest set bit of uMask, which must be nonzero */
+static unsigned SymTable_lowestBit(unsigned uMask) {
+#ifdef __GNUC__
+    return (unsigned)__builtin_ctz(uMask);
+#else
+    unsigned i = 0;
+
+    assert(uMask != 0);
+    while ((uMask & 1u) == 0) {
+        uMask >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+/* Returns the slot index holding pcKey (whose hash is uHash), or the
+ * slot count if pcKey is not in oSymTable.
+ * Groups are visited in triangular order, which covers every group
+ * when the group count is a power of two.
+ */
+static size_t SymTable_find(SymTable_T oSymTable, const char *pcKey,
+                            size_t uHash) {
+    size_t uMask = oSymTable->uGroupCount - 1;
+    size_t uGroup = SymTable_firstGroup(uHash, oSymTable->uGroupCount);
+    signed char cFingerprint = SymTable_fingerprint(uHash);
+    const signed char *pcGroup;
+    unsigned uMatches;
+    size_t uIndex;
+    size_t uStep;
+
+    for (uStep = 1; uStep <= oSymTable->uGroupCount; uStep++) {
+        TRACE_PROBE(oSymTable);
+        pcGroup = oSymTable->pcCtrl + uGroup * GROUP_WIDTH;
+
+        /* Only fingerprint matches reach strcmp */
+        for (uMatches = SymTable_matchByte(pcGroup, cFingerprint);
+             uMatches != 0; uMatches &= uMatches - 1) {
+            uIndex = uGroup * GROUP_WIDTH + SymTable_lowestBit(uMatches);
+            if (oSymTable->pSlots[uIndex].uHash == uHash) {
+                TRACE_KEY_COMPARE(oSymTable);
+                if (strcmp(oSymTable->pSlots[uIndex].pcKey, pcKey) == 0)
+                    return uIndex;
+            }
+        }
+
+        /* An empty slot ends the probe: the key was never pushed further */
+        if (SymTable_matchByte(pcGroup, CTRL_EMPTY) != 0)
+            break;
+
+        uGroup = (uGroup + uStep) & uMask;
+    }
+
+    return oSymTable->uGroupCount * GROUP_WIDTH;
+}
+
+/* Stores sNew in the first free slot along its probe sequence and
+ * returns that slot's index. The key must not already be present and
+ * there must be at least one free slot.
+ */
+static size_t SymTable_place(SymTable_T oSymTable, Slot sNew) {
+    size_t uMask = oSymTable->uGroupCount - 1;
+    size_t uGroup = SymTable_firstGroup(sNew.uHash, oSymTable->uGroupCount);
+    unsigned uFree;
+    size_t uIndex;
+    size_t uStep;
+
+    for (uStep = 1; ; uStep++) {
+        uFree = SymTable_matchFree(oSymTable->pcCtrl + uGroup * GROUP_WIDTH);
+        if (uFree != 0)
+            break;
+        uGroup = (uGroup + uStep) & uMask;
+    }
+
+    uIndex = uGroup * GROUP_WIDTH + SymTable_lowestBit(uFree);
+    if (oSymTable->pcCtrl[uIndex] == CTRL_DELETED)
+        oSymTable->uDeleted--;
+
+    oSymTable->pcCtrl[uIndex] = SymTable_fingerprint(sNew.uHash);
+    oSymTable->pSlots[uIndex] = sNew;
+
+    return uIndex;
+}
+
+/* Allocates control bytes and slots for uGroupCount groups and marks
+ * every slot empty. Returns 1 if successful, 0 if memory allocation
+ * fails (in which case oSymTable is unchanged).
+ */
+static int SymTable_allocGroups(SymTable_T oSymTable, size_t uGroupCount) {
+    signed char *pcCtrl;
+    Slot *pSlots;
+
+    pcCtrl = oSymTable->pfAlloc(uGroupCount * GROUP_WIDTH,
+                                oSymTable->pvAllocExtra);
+    if (pcCtrl == NULL)
+        return 0;
+
+    pSlots = oSymTable->pfAlloc(uGroupCount * GROUP_WIDTH * sizeof(Slot),
+                                oSymTable->pvAllocExtra);
+    if (pSlots == NULL) {
+        oSymTable->pfFree(pcCtrl, uGroupCount * GROUP_WIDTH,
+                          oSymTable->pvAllocExtra);
+        return 0;
+    }
+
+    memset(pcCtrl, CTRL_EMPTY, uGroupCount * GROUP_WIDTH);
+
+    oSymTable->pcCtrl = pcCtrl;
+    oSymTable->pSlots = pSlots;
+    oSymTable->uGroupCount = uGroupCount;
+    oSymTable->uDeleted = 0;
+
+    return 1;
+}
+
+/* Frees pcCtrl and pSlots, the control bytes and slots of uGroupCount
+ * groups allocated by SymTable_allocGroups, but not the key copies.
+ * oSymTable must not be NULL.
+ */
+static void SymTable_freeGroups(SymTable_T oSymTable, signed char *pcCtrl,
+                                Slot *pSlots, size_t uGroupCount) {
+    assert(oSymTable != NULL);
+
+    oSymTable->pfFree(pcCtrl, uGroupCount * GROUP_WIDTH,
+                      oSymTable->pvAllocExtra);
+    oSymTable->pfFree(pSlots, uGroupCount * GROUP_WIDTH * sizeof(Slot),
+                      oSymTable->pvAllocExtra);
+}
+
+/* Rebuilds the table with uGroupCount groups, reinserting every
+ * binding and dropping all tombstones.
+ * Returns 1 if successful, 0 if memory allocation fails.
+ * oSymTable must not be NULL.
+ */
+static int SymTable_rehash(SymTable_T oSymTable, size_t uGroupCount) {
+    signed char *pcOldCtrl = oSymTable->pcCtrl;
+    Slot *pOldSlots = oSymTable->pSlots;
+    size_t uOldGroupCount = oSymTable->uGroupCount;
+    size_t uOldSlotCount = uOldGroupCount * GROUP_WIDTH;
+    size_t i;
+
+    assert(oSymTable != NULL);
+
+    if (!SymTable_allocGroups(oSymTable, uGroupCount))
+        return 0;
+    if (uGroupCount > uOldGroupCount)
+        oSymTable->uExpansions++;
+    else if (uGroupCount < uOldGroupCount)
+        oSymTable->uShrinks++;
+
+    /* Reinsert using the cached hashes */
+    for (i = 0; i < uOldSlotCount; i++) {
+        if (pcOldCtrl[i] >= 0)
+            SymTable_place(oSymTable, pOldSlots[i]);
+    }
+
+    SymTable_freeGroups(oSymTable, pcOldCtrl, pOldSlots, uOldGroupCount);
+    return 1;
+}
+
+/* Returns the smallest power-of-two group count, no smaller than
+ * INITIAL_GROUP_COUNT, whose slots hold uCapacity bindings within the
+ * maximum load factor of 7/8, or 0 if no such count fits in a size_t.
+ */
+static size_t SymTable_groupsFor(size_t uCapacity) {
+    size_t uGroupCount = INITIAL_GROUP_COUNT;
+
+    while (uCapacity > uGroupCount * GROUP_WIDTH / 8 * 7) {
+        if (uGroupCount > (size_t)-1 / 2 / (GROUP_WIDTH * sizeof(Slot)))
+            return 0;
+        uGroupCount *= 2;
+    }
+
+    return uGroupCount;
+}
+
+/* Creates and returns a new empty table sized for uCapacity bindings,
+ * whose memory comes from pfAlloc and goes back through pfFree.
+ * Returns NULL if insufficient memory is available.
+ * pfAlloc and pfFree must not be NULL.
+ */
+static SymTable_T SymTable_create(
+    size_t uCapacity,
+    void *(*pfAlloc)(size_t uSize, void *pvAllocExtra),
+    void (*pfFree)(void *pvBlock, size_t uSize, void *pvAllocExtra),
+    void *pvAllocExtra) {
+    SymTable_T oSymTable;
+    size_t uGroupCount;
+
+    assert(pfAlloc != NULL);
+    assert(pfFree != NULL);
+
+    uGroupCount = SymTable_groupsFor(uCapacity);
+    if (uGroupCount == 0)
+        return NULL;
+
+    oSymTable = pfAlloc(sizeof(struct SymTable), pvAllocExtra);
+    if (oSymTable == NULL)
+        return NULL;
+
+    oSymTable->uLength = 0;
+    oSymTable->oArena = NULL;
+    oSymTable->pfHash = NULL;
+    oSymTable->pvHashExtra = NULL;
+    oSymTable->pfAlloc = pfAlloc;
+    oSymTable->pfFree = pfFree;
+    oSymTable->pvAllocExtra = pvAllocExtra;
+    oSymTable->uExpansions = 0;
+    oSymTable->uShrinks = 0;
+    TRACE_INIT(oSymTable);
+
+    if (!SymTable_allocGroups(oSymTable, uGroupCount)) {
+        pfFree(oSymTable, sizeof(struct SymTable), pvAllocExtra);
+        return NULL;
+    }
+
+    return oSymTable;
+}
+
+SymTable_T SymTable_new(void) {
+    return SymTable_newWithCapacity(0);
+}
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+    return SymTable_create(uCapacity, SymTable_defaultAlloc,
+                           SymTable_defaultFree, NULL);
+}
+
+SymTable_T SymTable_newWithAllocator(
+    void *(*pfAlloc)(size_t uSize, void *pvAllocExtra),
+    void (*pfFree)(void *pvBlock, size_t uSize, void *pvAllocExtra),
+    void *pvAllocExtra) {
+    return SymTable_create(0, pfAlloc, pfFree, pvAllocExtra);
+}
+
+SymTable_T SymTable_newWithHash(
+    size_t (*pfHash)(const char *pcKey, size_t uKeyLength,
+                     const void *pvHashExtra),
+    const void *pvHashExtra) {
+    SymTable_T oSymTable;
+
+    assert(pfHash != NULL);
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+        return NULL;
+
+    oSymTable->pfHash = pfHash;
+    oSymTable->pvHashExtra = pvHashExtra;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newSeeded(void) {
+    SymTable_T oSymTable;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+        return NULL;
+
+    /* The hash key lives in the table and is freed with it */
+    HashFn_randomSeed(oSymTable->aullSeed);
+    oSymTable->pfHash = SymTable_hashSiphash13;
+    oSymTable->pvHashExtra = oSymTable->aullSeed;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newArena(void) {
+    SymTable_T oSymTable;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+        return NULL;
+
+    /* Key copies come from the arena from the first put on */
+    oSymTable->oArena = Arena_new();
+    if (oSymTable->oArena == NULL) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+
+    return oSymTable;
+}
+
+void SymTable_free(SymTable_T oSymTable) {
+    size_t uSlotCount;
+    size_t i;
+
+    assert(oSymTable != NULL);
+
+    /* Free the key copies of full slots, or all at once from the arena */
+    if (oSymTable->oArena != NULL)
+        Arena_free(oSymTable->oArena);
+    else {
+        uSlotCount = oSymTable->uGroupCount * GROUP_WIDTH;
+        for (i = 0; i < uSlotCount; i++) {
+            if (oSymTable->pcCtrl[i] >= 0)
+                SymTable_freeKey(oSymTable, oSymTable->pSlots[i].pcKey);
+        }
+    }
+
+    SymTable_freeGroups(oSymTable, oSymTable->pcCtrl, oSymTable->pSlots,
+                        oSymTable->uGroupCount);
+    oSymTable->pfFree(oSymTable, sizeof(struct SymTable),
+                      oSymTable->pvAllocExtra);
+}
+
+/* Adds a binding of pcKey, whose hash is uHash, to pvValue, first
+ * rehashing if the binding would push full plus deleted slots above 7/8.
+ * pcKey must not be in the table already.
+ * Returns the index of the slot holding the new binding, or INSERT_FAILED
+ * if insufficient memory is available.
+ * oSymTable and pcKey must not be NULL.
+ */
+static size_t SymTable_insert(SymTable_T oSymTable, const char *pcKey,
+                              size_t uHash, const void *pvValue) {
+    size_t uSlotCount;
+    size_t uGroupCount;
+    Slot sNew;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /* Keep full plus deleted slots at or below 7/8 so probes find an
+     * empty slot quickly; rehash in place when tombstones are the cause */
+    uSlotCount = oSymTable->uGroupCount * GROUP_WIDTH;
+    if ((oSymTable->uLength + oSymTable->uDeleted + 1) * 8 > uSlotCount * 7) {
+        uGroupCount = oSymTable->uGroupCount;
+        if ((oSymTable->uLength + 1) * 16 > uSlotCount * 7)
+            uGroupCount *= 2;
+        if (!SymTable_rehash(oSymTable, uGroupCount))
+            return INSERT_FAILED;
+    }
+
+    /* Create defensive copy of the key */
+    sNew.pcKey = SymTable_copyKey(oSymTable, pcKey);
+    if (sNew.pcKey == NULL)
+        return INSERT_FAILED;
+    sNew.uHash = uHash;
+
+    /* Store the value pointer (no defensive copy) */
+    sNew.pvValue = pvValue;
+
+    oSymTable->uLength++;
+    return SymTable_place(oSymTable, sNew);
+}
+
+/* Looks up apcKeys[0..uCount-1] as SymTable_getMany does, uBatchSize
+ * keys at a time: hashes a batch and prefetches where each of its probes
+ * begins, so that the probes find their first cache lines loaded.
+ * Returns the number of keys found.
+ */
+static size_t SymTable_getBatches(SymTable_T oSymTable, const char *apcKeys[],
+                                  size_t uCount, void *apvValues[],
+                                  size_t uBatchSize) {
+    size_t auHashes[SYMTABLE_MAX_INTERLEAVE];
+    size_t uGroup;
+    size_t uStart;
+    size_t uBatch;
+    size_t uIndex;
+    size_t uFound = 0;
+    size_t i;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL);
+    assert(apvValues != NULL);
+    assert(uBatchSize >= 1 && uBatchSize <= SYMTABLE_MAX_INTERLEAVE);
+
+    for (uStart = 0; uStart < uCount; uStart += uBatch) {
+        uBatch = uCount - uStart < uBatchSize ? uCount - uStart : uBatchSize;
+
+        /* Hash every key of the batch and start loading where its
+         * probe begins */
+        for (i = 0; i < uBatch; i++) {
+            assert(apcKeys[uStart + i] != NULL);
+            auHashes[i] = SymTable_hash(oSymTable, apcKeys[uStart + i]);
+            uGroup = SymTable_firstGroup(auHashes[i], oSymTable->uGroupCount);
+            PREFETCH(oSymTable->pcCtrl + uGroup * GROUP_WIDTH);
+            PREFETCH(oSymTable->pSlots + uGroup * GROUP_WIDTH);
+        }
+
+        /* Then probe, mostly through lines that are already cached */
+        for (i = 0; i < uBatch; i++) {
+            uIndex = SymTable_find(oSymTable, apcKeys[uStart + i],
+                                   auHashes[i]);
+            if (uIndex == oSymTable->uGroupCount * GROUP_WIDTH) {
+                apvValues[uStart + i] = NULL;
+                continue;
+            }
+            apvValues[uStart + i] = (void *)oSymTable->pSlots[uIndex].pvValue;
+            uFound++;
+        }
+    }
+
+    return uFound;
+}
+
+/* A MapJob structure holds the arguments of SymTable_mapParallel for
+ * each of its threads */
+typedef struct MapJob {
+    SymTable_T oSymTable;
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+    void *pvExtra;
+} MapJob;
+
+/* Applies the function of pvMapJob, a MapJob, to every binding in
+ * slots uStart to uEnd - 1 of its table.
+ */
+static void SymTable_mapRange(size_t uStart, size_t uEnd, void *pvMapJob) {
+    const MapJob *psJob = pvMapJob;
+    SymTable_T oSymTable = psJob->oSymTable;
+    size_t i;
+
+    for (i = uStart; i < uEnd; i++) {
+        if (oSymTable->pcCtrl[i] >= 0)
+            psJob->pfApply(oSymTable->pSlots[i].pcKey,
+                           (void *)oSymTable->pSlots[i].pvValue,
+                           psJob->pvExtra);
+    }
+}
+
+/* The operations of symtable.h, which the public functions below time
+ * when built with -DSYMTABLE_TRACE */
+
+static int SymTable_doReserve(SymTable_T oSymTable, size_t uCapacity) {
+    size_t uGroupCount;
+
+    assert(oSymTable != NULL);
+
+    uGroupCount = SymTable_groupsFor(uCapacity);
+    if (uGroupCount == 0)
+        return 0;
+
+    /* Tombstones count against the load factor too, so rebuild when
+     * the bindings already present plus the reservation would not fit */
+    if (uGroupCount > oSymTable->uGroupCount ||
+        (uCapacity + oSymTable->uDeleted) * 8 >
+            oSymTable->uGroupCount * GROUP_WIDTH * 7)
+        return SymTable_rehash(oSymTable, uGroupCount > oSymTable->uGroupCount
+                                          ? uGroupCount : oSymTable->uGroupCount);
+
+    return 1;
+}
+
+static size_t SymTable_doGetLength(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+
+    return oSymTable->uLength;
+}
+
+static int SymTable_doPut(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    size_t uHash;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hash(oSymTable, pcKey);
+
+    /* Check if key already exists */
+    if (SymTable_find(oSymTable, pcKey, uHash)
+        != oSymTable->uGroupCount * GROUP_WIDTH)
+        return 0;
+
+    return SymTable_insert(oSymTable, pcKey, uHash, pvValue) != INSERT_FAILED;
+}
+
+static void *SymTable_doReplace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    size_t uIndex;
+    const void *pvOld;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(oSymTable, pcKey));
+    if (uIndex == oSymTable->uGroupCount * GROUP_WIDTH)
+        return NULL;
+
+    pvOld = oSymTable->pSlots[uIndex].pvValue;
+    oSymTable->pSlots[uIndex].pvValue = pvValue;
+
+    return (void *)pvOld;
+}
+
+static int SymTable_doContains(SymTable_T oSymTable, const char *pcKey) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    return SymTable_find(oSymTable, pcKey, SymTable_hash(oSymTable, pcKey))
+        != oSymTable->uGroupCount * GROUP_WIDTH;
+}
+
+static void *SymTable_doGet(SymTable_T oSymTable, const char *pcKey) {
+    size_t uIndex;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(oSymTable, pcKey));
+    if (uIndex == oSymTable->uGroupCount * GROUP_WIDTH)
+        return NULL;
+
+    return (void *)oSymTable->pSlots[uIndex].pvValue;
+}
+
+static void *SymTable_doRemove(SymTable_T oSymTable, const char *pcKey) {
+    size_t uIndex;
+    const signed char *pcGroup;
+    const void *pvValue;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(oSymTable, pcKey));
+    if (uIndex == oSymTable->uGroupCount * GROUP_WIDTH)
+        return NULL;
+
+    pvValue = oSymTable->pSlots[uIndex].pvValue;
+    SymTable_freeKey(oSymTable, oSymTable->pSlots[uIndex].pcKey);
+
+    /* If the group still has an empty slot, every probe through it
+     * stops here anyway, so the slot can become empty again; otherwise
+     * a tombstone keeps later probes going */
+    pcGroup = oSymTable->pcCtrl + (uIndex / GROUP_WIDTH) * GROUP_WIDTH;
+    if (SymTable_matchByte(pcGroup, CTRL_EMPTY) != 0)
+        oSymTable->pcCtrl[uIndex] = CTRL_EMPTY;
+    else {
+        oSymTable->pcCtrl[uIndex] = CTRL_DELETED;
+        oSymTable->uDeleted++;
+    }
+
+    oSymTable->uLength--;
+
+    return (void *)pvValue;
+}
+
+static void SymTable_doMap(SymTable_T oSymTable,
+                           void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                           const void *pvExtra) {
+    size_t uSlotCount;
+    size_t i;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    uSlotCount = oSymTable->uGroupCount * GROUP_WIDTH;
+    for (i = 0; i < uSlotCount; i++) {
+        if (oSymTable->pcCtrl[i] >= 0)
+            pfApply(oSymTable->pSlots[i].pcKey,
+                    (void *)oSymTable->pSlots[i].pvValue, (void *)pvExtra);
+    }
+}
+
+static int SymTable_doUpsert(SymTable_T oSymTable, const char *pcKey,
+                             const void *pvValue, void **ppvOldValue) {
+    size_t uHash;
+    size_t uIndex;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /* One hash and one probe, whatever the outcome */
+    uHash = SymTable_hash(oSymTable, pcKey);
+    uIndex = SymTable_find(oSymTable, pcKey, uHash);
+
+    if (uIndex != oSymTable->uGroupCount * GROUP_WIDTH) {
+        if (ppvOldValue != NULL)
+            *ppvOldValue = (void *)oSymTable->pSlots[uIndex].pvValue;
+        oSymTable->pSlots[uIndex].pvValue = pvValue;
+        return 0;
+    }
+
+    if (SymTable_insert(oSymTable, pcKey, uHash, pvValue) == INSERT_FAILED)
+        return -1;
+    return 1;
+}
+
+static void *SymTable_doGetOrPut(SymTable_T oSymTable, const char *pcKey,
+                                 const void *pvValue, int *piAdded) {
+    size_t uHash;
+    size_t uIndex;
+    int iAdded = 0;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hash(oSymTable, pcKey);
+    uIndex = SymTable_find(oSymTable, pcKey, uHash);
+
+    if (uIndex == oSymTable->uGroupCount * GROUP_WIDTH) {
+        uIndex = SymTable_insert(oSymTable, pcKey, uHash, pvValue);
+        iAdded = uIndex != INSERT_FAILED ? 1 : -1;
+    }
+
+    if (piAdded != NULL)
+        *piAdded = iAdded;
+    if (iAdded < 0)
+        return NULL;
+    return (void *)oSymTable->pSlots[uIndex].pvValue;
+}
+
+static void *SymTable_doGetFound(SymTable_T oSymTable, const char *pcKey,
+                                 int *piFound) {
+    size_t uIndex;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(piFound != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(oSymTable, pcKey));
+
+    *piFound = uIndex != oSymTable->uGroupCount * GROUP_WIDTH;
+    if (uIndex == oSymTable->uGroupCount * GROUP_WIDTH)
+        return NULL;
+    return (void *)oSymTable->pSlots[uIndex].pvValue;
+}
+
+static void **SymTable_doEntry(SymTable_T oSymTable, const char *pcKey,
+                               int *piCreated) {
+    size_t uHash;
+    size_t uIndex;
+    int iCreated = 0;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hash(oSymTable, pcKey);
+    uIndex = SymTable_find(oSymTable, pcKey, uHash);
+
+    if (uIndex == oSymTable->uGroupCount * GROUP_WIDTH) {
+        uIndex = SymTable_insert(oSymTable, pcKey, uHash, NULL);
+        iCreated = uIndex != INSERT_FAILED;
+    }
+
+    if (piCreated != NULL)
+        *piCreated = iCreated;
+    if (uIndex == INSERT_FAILED)
+        return NULL;
+    return (void **)&oSymTable->pSlots[uIndex].pvValue;
+}
+
+static size_t SymTable_doGetMany(SymTable_T oSymTable, const char *apcKeys[],
+                                 size_t uCount, void *apvValues[]) {
+    return SymTable_getBatches(oSymTable, apcKeys, uCount, apvValues,
+                               GET_MANY_BATCH);
+}
+
+static size_t SymTable_doGetManyInterleaved(SymTable_T oSymTable,
+                                            const char *apcKeys[],
+                                            size_t uCount, void *apvValues[],
+                                            size_t uWidth) {
+    return SymTable_getBatches(oSymTable, apcKeys, uCount, apvValues, uWidth);
+}
+
+static size_t SymTable_doPutMany(SymTable_T oSymTable, const char *apcKeys[],
+                                 const void *apvValues[], size_t uCount,
+                                 int aiAdded[]) {
+    size_t auHashes[GET_MANY_BATCH];
+    size_t uGroup;
+    size_t uStart;
+    size_t uBatch;
+    size_t uIndex;
+    size_t uAdded = 0;
+    size_t i;
+    int iAdded;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL);
+    assert(apvValues != NULL);
+
+    /* Grow once, straight to a size that holds every key, so that no
+     * insert below has to. If that fails, the inserts grow the table as
+     * they need to. */
+    if (uCount <= (size_t)-1 - oSymTable->uLength)
+        (void)SymTable_doReserve(oSymTable, oSymTable->uLength + uCount);
+
+    for (uStart = 0; uStart < uCount; uStart += uBatch) {
+        uBatch = uCount - uStart < GET_MANY_BATCH ? uCount - uStart
+                                                  : GET_MANY_BATCH;
+
+        /* Hash the batch in one tight loop, prefetching where each probe
+         * begins */
+        for (i = 0; i < uBatch; i++) {
+            assert(apcKeys[uStart + i] != NULL);
+            auHashes[i] = SymTable_hash(oSymTable, apcKeys[uStart + i]);
+            uGroup = SymTable_firstGroup(auHashes[i], oSymTable->uGroupCount);
+            PREFETCH(oSymTable->pcCtrl + uGroup * GROUP_WIDTH);
+        }
+
+        for (i = 0; i < uBatch; i++) {
+            iAdded = 0;
+            if (SymTable_find(oSymTable, apcKeys[uStart + i], auHashes[i])
+                == oSymTable->uGroupCount * GROUP_WIDTH) {
+                uIndex = SymTable_insert(oSymTable, apcKeys[uStart + i],
+                                         auHashes[i], apvValues[uStart + i]);
+                iAdded = uIndex != INSERT_FAILED;
+            }
+            if (aiAdded != NULL)
+                aiAdded[uStart + i] = iAdded;
+            uAdded += (size_t)iAdded;
+        }
+    }
+
+    return uAdded;
+}
+
+static void SymTable_doMapParallel(SymTable_T oSymTable,
+                                   void (*pfApply)(const char *pcKey,
+                                                   void *pvValue,
+                                                   void *pvExtra),
+                                   const void *pvExtra, size_t uThreads) {
+    MapJob sJob;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    assert(uThreads >= 1);
+
+    sJob.oSymTable = oSymTable;
+    sJob.pfApply = pfApply;
+    sJob.pvExtra = (void *)pvExtra;
+
+    Parallel_forRanges(oSymTable->uGroupCount * GROUP_WIDTH, uThreads, SymTable_mapRange, &sJob);
+}
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+    int iResult;
+
+    TRACE_START();
+    iResult = SymTable_doReserve(oSymTable, uCapacity);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_RESERVE);
+    return iResult;
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+    size_t uLength;
+
+    TRACE_START();
+    uLength = SymTable_doGetLength(oSymTable);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_LENGTH);
+    return uLength;
+}
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    int iResult;
+
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    iResult = SymTable_doPut(oSymTable, pcKey, pvValue);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_PUT,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return iResult;
+}
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    void *pvOld;
+
+    TRACE_START();
+    pvOld = SymTable_doReplace(oSymTable, pcKey, pvValue);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_REPLACE);
+    return pvOld;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    int iResult;
+
+    TRACE_START();
+    iResult = SymTable_doContains(oSymTable, pcKey);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_CONTAINS);
+    return iResult;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    void *pvValue;
+
+    TRACE_START();
+    pvValue = SymTable_doGet(oSymTable, pcKey);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET);
+    return pvValue;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    void *pvValue;
+
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    pvValue = SymTable_doRemove(oSymTable, pcKey);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_REMOVE,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return pvValue;
+}
+
+void SymTable_map(SymTable_T oSymTable,
+                  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                  const void *pvExtra) {
+    TRACE_START();
+    SymTable_doMap(oSymTable, pfApply, pvExtra);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_MAP);
+}
+
+int SymTable_upsert(SymTable_T oSymTable, const char *pcKey, const void *pvValue,
+                    void **ppvOldValue) {
+    int iResult;
+
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    iResult = SymTable_doUpsert(oSymTable, pcKey, pvValue, ppvOldValue);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_UPSERT,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return iResult;
+}
+
+void *SymTable_getOrPut(SymTable_T oSymTable, const char *pcKey,
+                        const void *pvValue, int *piAdded) {
+    void *pvResult;
+
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    pvResult = SymTable_doGetOrPut(oSymTable, pcKey, pvValue, piAdded);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_GET_OR_PUT,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return pvResult;
+}
+
+void *SymTable_getFound(SymTable_T oSymTable, const char *pcKey, int *piFound) {
+    void *pvValue;
+
+    TRACE_START();
+    pvValue = SymTable_doGetFound(oSymTable, pcKey, piFound);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_FOUND);
+    return pvValue;
+}
+
+void **SymTable_entry(SymTable_T oSymTable, const char *pcKey, int *piCreated) {
+    void **ppvValue;
+
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    ppvValue = SymTable_doEntry(oSymTable, pcKey, piCreated);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_ENTRY,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return ppvValue;
+}
+
+size_t SymTable_getMany(SymTable_T oSymTable, const char *apcKeys[],
+                        size_t uCount, void *apvValues[]) {
+    size_t uFound;
+
+    TRACE_START();
+    uFound = SymTable_doGetMany(oSymTable, apcKeys, uCount, apvValues);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_MANY);
+    return uFound;
+}
+
+size_t SymTable_getManyInterleaved(SymTable_T oSymTable, const char *apcKeys[],
+                                   size_t uCount, void *apvValues[],
+                                   size_t uWidth) {
+    size_t uFound;
+
+    TRACE_START();
+    uFound = SymTable_doGetManyInterleaved(oSymTable, apcKeys, uCount,
+                                           apvValues, uWidth);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_GET_MANY_INTERLEAVED);
+    return uFound;
+}
+
+size_t SymTable_putMany(SymTable_T oSymTable, const char *apcKeys[],
+                        const void *apvValues[], size_t uCount, int aiAdded[]) {
+    size_t uAdded;
+
+    TRACE_START_RESIZING(oSymTable->uExpansions + oSymTable->uShrinks);
+    uAdded = SymTable_doPutMany(oSymTable, apcKeys, apvValues, uCount,
+                                aiAdded);
+    TRACE_STOP_RESIZING(oSymTable, SYMTABLE_OP_PUT_MANY,
+                        oSymTable->uExpansions + oSymTable->uShrinks);
+    return uAdded;
+}
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+                          void (*pfApply)(const char *pcKey, void *pvValue,
+                                          void *pvExtra),
+                          const void *pvExtra, size_t uThreads) {
+    TRACE_START();
+    SymTable_doMapParallel(oSymTable, pfApply, pvExtra, uThreads);
+    TRACE_STOP(oSymTable, SYMTABLE_OP_MAP_PARALLEL);
+}
+
+/* Iterators are not timed by -DSYMTABLE_TRACE: a call of
+ * SymTable_iterNext costs less than reading the clock. */
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable) {
+    SymTableIter_T oIter;
+
+    assert(oSymTable != NULL);
+
+    oIter = oSymTable->pfAlloc(sizeof(struct SymTableIter),
+                               oSymTable->pvAllocExtra);
+    if (oIter == NULL)
+        return NULL;
+
+    oIter->oSymTable = oSymTable;
+    oIter->uNextSlot = 0;
+
+    return oIter;
+}
+
+int SymTable_iterNext(SymTableIter_T oIter, const char **ppcKey,
+                      void **ppvValue) {
+    SymTable_T oSymTable;
+    const Slot *pSlot;
+
+    assert(oIter != NULL);
+
+    /* Skip empty (and deleted) slots */
+    oSymTable = oIter->oSymTable;
+    while (oIter->uNextSlot < oSymTable->uGroupCount * GROUP_WIDTH && oSymTable->pcCtrl[oIter->uNextSlot] < 0)
+        oIter->uNextSlot++;
+    if (oIter->uNextSlot == oSymTable->uGroupCount * GROUP_WIDTH)
+        return 0;
+
+    pSlot = &oSymTable->pSlots[oIter->uNextSlot++];
+    if (ppcKey != NULL)
+        *ppcKey = pSlot->pcKey;
+    if (ppvValue != NULL)
+        *ppvValue = (void *)pSlot->pvValue;
+    return 1;
+}
+
+void SymTable_iterEnd(SymTableIter_T oIter) {
+    assert(oIter != NULL);
+
+    oIter->oSymTable->pfFree(oIter, sizeof(struct SymTableIter),
+                             oIter->oSymTable->pvAllocExtra);
+}
+
+/* Adds a bucket whose chain holds uChainLength bindings to the chain
+ * counts of *psStats */
+static void SymTable_addChain(SymTable_Stats *psStats, size_t uChainLength) {
+    if (uChainLength == 0)
+        psStats->uEmptyBuckets++;
+    if (uChainLength > psStats->uMaxChainLength)
+        psStats->uMaxChainLength = uChainLength;
+
+    if (uChainLength > SYMTABLE_HISTOGRAM_SIZE - 1)
+        uChainLength = SYMTABLE_HISTOGRAM_SIZE - 1;
+    psStats->auChainLengths[uChainLength]++;
+}
+
+int SymTable_getStats(SymTable_T oSymTable, SymTable_Stats *psStats) {
+    size_t *puChainLengths;
+    size_t uSlotCount;
+    size_t uGroupCount;
+    size_t i;
+
+    assert(oSymTable != NULL);
+    assert(psStats != NULL);
+
+    /* Bindings of one home group can sit in any later group, so count
+     * them per group first */
+    uGroupCount = oSymTable->uGroupCount;
+    puChainLengths = oSymTable->pfAlloc(uGroupCount * sizeof(size_t),
+                                        oSymTable->pvAllocExtra);
+    if (puChainLengths == NULL)
+        return 0;
+    for (i = 0; i < uGroupCount; i++)
+        puChainLengths[i] = 0;
+
+    uSlotCount = uGroupCount * GROUP_WIDTH;
+    for (i = 0; i < uSlotCount; i++) {
+        if (oSymTable->pcCtrl[i] >= 0)
+            puChainLengths[SymTable_firstGroup(oSymTable->pSlots[i].uHash,
+                                               uGroupCount)]++;
+    }
+
+    memset(psStats, 0, sizeof(*psStats));
+    psStats->uLength = oSymTable->uLength;
+    psStats->uBucketCount = uGroupCount;
+    psStats->uExpansions = oSymTable->uExpansions;
+    psStats->uShrinks = oSymTable->uShrinks;
+    TRACE_STATS(oSymTable, psStats);
+    for (i = INITIAL_GROUP_COUNT; i < uGroupCount; i *= 2)
+        psStats->uGrowthStep++;
+
+    for (i = 0; i < uGroupCount; i++)
+        SymTable_addChain(psStats, puChainLengths[i]);
+
+    if (psStats->uLength > 0)
+        psStats->dMeanChainLength = (double)psStats->uLength /
+            (double)(uGroupCount - psStats->uEmptyBuckets);
+
+    oSymTable->pfFree(puChainLengths, uGroupCount * sizeof(size_t),
+                      oSymTable->pvAllocExtra);
+    return 1;
+}
+
+int SymTable_getLatencyHistogram(SymTable_T oSymTable, enum SymTable_Op eOp,
+                                 unsigned long aulCounts[]) {
+    assert(oSymTable != NULL);
+    assert(eOp < SYMTABLE_OP_COUNT);
+    assert(aulCounts != NULL);
+
+#ifdef SYMTABLE_TRACE
+    memcpy(aulCounts, oSymTable->aaulLatencies[eOp],
+           sizeof(oSymTable->aaulLatencies[eOp]));
+    return 1;
+#else
+    (void)oSymTable;
+    (void)eOp;
+    (void)aulCounts;
+    return 0;
+#endif
+}
@@ -0,0 +1,70 @@
+/* Author: Nicholas Budny */
+
+/* symtabletrace.c - Implementation of the latency histograms shared by
+ * the SymTable implementations */
+
+#include <assert.h>
+#include <time.h>
+#include "symtabletrace.h"
+
+/* Each power of two of ticks is split into 2^SUB_BITS buckets, so a
+ * bucket is at most 1/2^SUB_BITS wider than its lower bound */
+enum { SUB_BITS = 3 };
+
+/* Number of buckets per power of two */
+enum { SUB_COUNT = 1 << SUB_BITS };
+
+unsigned long long Trace_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    unsigned long long ullTicks;
+
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ullTicks));
+    return ullTicks;
+#else
+    return (unsigned long long)clock();
+#endif
+}
+
+/* Returns the histogram bucket for a latency of ullTicks: values below
+ * SUB_COUNT get a bucket each, larger ones share SUB_COUNT buckets per
+ * power of two, and the last bucket holds everything too large for the
+ * others.
+ */
+static size_t Trace_bucketFor(unsigned long long ullTicks) {
+    size_t uExponent = SUB_BITS;
+    size_t uBucket;
+
+    if (ullTicks < SUB_COUNT)
+        return (size_t)ullTicks;
+
+    /* Find the highest set bit */
+    while (uExponent < 63 && (ullTicks >> (uExponent + 1)) != 0)
+        uExponent++;
+
+    uBucket = (uExponent - SUB_BITS + 1) * SUB_COUNT +
+              (size_t)((ullTicks >> (uExponent - SUB_BITS)) & (SUB_COUNT - 1));
+    if (uBucket >= SYMTABLE_LATENCY_BUCKETS)
+        uBucket = SYMTABLE_LATENCY_BUCKETS - 1;
+    return uBucket;
+}
+
+void Trace_record(unsigned long aulCounts[], unsigned long long ullStart) {
+    assert(aulCounts != NULL);
+
+    aulCounts[Trace_bucketFor(Trace_now() - ullStart)]++;
+}
+
+unsigned long long SymTable_latencyBucketStart(size_t uBucket) {
+    size_t uExponent;
+
+    assert(uBucket < SYMTABLE_LATENCY_BUCKETS);
+
+    if (uBucket < SUB_COUNT)
+        return uBucket;
+
+    uExponent = uBucket / SUB_COUNT + SUB_BITS - 1;
+    return (unsigned long long)(SUB_COUNT + uBucket % SUB_COUNT) <<
+           (uExponent - SUB_BITS);
+}
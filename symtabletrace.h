@@ -0,0 +1,93 @@
+/* Author: Nicholas Budny */
+
+/* symtabletrace.h - latency tracing shared by the SymTable
+ * implementations. Compiled with -DSYMTABLE_TRACE, each public SymTable
+ * function records its latency in a histogram owned by its table, and
+ * searches count their probes and key comparisons in the table;
+ * otherwise the TRACE_ macros do nothing, and lookups leave the table
+ * untouched. */
+
+#ifndef SYMTABLETRACE_H
+#define SYMTABLETRACE_H
+
+#include <string.h>
+#include "symtable.h"
+
+/* Returns the current value of a fast, monotonic tick counter: the time
+ * stamp counter on x86, the virtual counter on AArch64, and clock()
+ * elsewhere.
+ */
+unsigned long long Trace_now(void);
+
+/* Adds one call that started at tick ullStart and ends now to the
+ * latency histogram aulCounts, which has SYMTABLE_LATENCY_BUCKETS
+ * entries.
+ * aulCounts must not be NULL.
+ */
+void Trace_record(unsigned long aulCounts[], unsigned long long ullStart);
+
+#ifdef SYMTABLE_TRACE
+
+/* Members of struct SymTable holding a latency histogram per operation,
+ * the number of bindings, slots or groups examined by searches, and the
+ * number of key comparisons those searches made */
+#define TRACE_MEMBERS \
+    unsigned long aaulLatencies[SYMTABLE_OP_COUNT][SYMTABLE_LATENCY_BUCKETS]; \
+    size_t uProbes; \
+    size_t uKeyCompares;
+
+/* Clears the latency histograms and search counts of oSymTable */
+#define TRACE_INIT(oSymTable) \
+    (memset((oSymTable)->aaulLatencies, 0, \
+            sizeof((oSymTable)->aaulLatencies)), \
+     (oSymTable)->uProbes = 0, (oSymTable)->uKeyCompares = 0)
+
+/* Counts one binding, slot or group examined by a search of oSymTable */
+#define TRACE_PROBE(oSymTable) ((oSymTable)->uProbes++)
+
+/* Counts one key comparison made by a search of oSymTable */
+#define TRACE_KEY_COMPARE(oSymTable) ((oSymTable)->uKeyCompares++)
+
+/* Stores the search counts of oSymTable in *psStats */
+#define TRACE_STATS(oSymTable, psStats) \
+    ((psStats)->uProbes = (oSymTable)->uProbes, \
+     (psStats)->uKeyCompares = (oSymTable)->uKeyCompares)
+
+/* Declaration starting the timing of a public function */
+#define TRACE_START() \
+    unsigned long long ullTraceStart = Trace_now()
+
+/* Declarations starting the timing of a public function that may resize
+ * the table. uResizes is the table's resize count, so that
+ * TRACE_STOP_RESIZING can tell whether the call resized it. */
+#define TRACE_START_RESIZING(uResizes) \
+    unsigned long long ullTraceStart = Trace_now(); \
+    size_t uTraceResizes = (uResizes)
+
+/* Records the call started by TRACE_START as an eOp operation */
+#define TRACE_STOP(oSymTable, eOp) \
+    Trace_record((oSymTable)->aaulLatencies[eOp], ullTraceStart)
+
+/* Records the call started by TRACE_START_RESIZING as an eOp operation,
+ * or as a SYMTABLE_OP_RESIZE if the resize count is no longer uResizes */
+#define TRACE_STOP_RESIZING(oSymTable, eOp, uResizes) \
+    Trace_record((oSymTable)->aaulLatencies[(uResizes) != uTraceResizes ? \
+                                            SYMTABLE_OP_RESIZE : (eOp)], \
+                 ullTraceStart)
+
+#else
+
+#define TRACE_MEMBERS
+#define TRACE_INIT(oSymTable)
+#define TRACE_PROBE(oSymTable) ((void)(oSymTable))
+#define TRACE_KEY_COMPARE(oSymTable) ((void)(oSymTable))
+#define TRACE_STATS(oSymTable, psStats) \
+    ((psStats)->uProbes = 0, (psStats)->uKeyCompares = 0)
+#define TRACE_START()
+#define TRACE_START_RESIZING(uResizes)
+#define TRACE_STOP(oSymTable, eOp)
+#define TRACE_STOP_RESIZING(oSymTable, eOp, uResizes)
+
+#endif
+
+#endif
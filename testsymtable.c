@@ -776,10 +776,1241 @@ static void testCollisions(void)
 
 /*--------------------------------------------------------------------*/
 
+/* Test SymTable_newWithCapacity() and SymTable_reserve(). */
+
+static void testReserve(void)
+{
+   enum {BINDING_COUNT = 2000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+   size_t uLength;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_newWithCapacity() and SymTable_reserve().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newWithCapacity(0);
+   ASSURE(oSymTable != NULL);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 0);
+   SymTable_free(oSymTable);
+
+   oSymTable = SymTable_newWithCapacity(BINDING_COUNT);
+   ASSURE(oSymTable != NULL);
+
+   iSuccessful = SymTable_put(oSymTable, "Jeter", acShortstop);
+   ASSURE(iSuccessful);
+
+   /* Reserving less than the current capacity changes nothing. */
+   iSuccessful = SymTable_reserve(oSymTable, 1);
+   ASSURE(iSuccessful);
+
+   /* Reserving more keeps the existing bindings. */
+   iSuccessful = SymTable_reserve(oSymTable, 4 * BINDING_COUNT);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(pcValue == acShortstop);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == BINDING_COUNT + 1);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+   pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(pcValue == acShortstop);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 1);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable object created by SymTable_newArena(), including
+   reuse of removed bindings and keys longer than a small block. */
+
+static void testArena(void)
+{
+   enum {BINDING_COUNT = 3000, MAX_KEY_LENGTH = 10, LONG_KEY_SIZE = 1000};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acLongKey[LONG_KEY_SIZE];
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char *pcValue;
+   int i;
+   int iRound;
+   int iSuccessful;
+   size_t uLength;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object in arena mode.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (i = 0; i < LONG_KEY_SIZE - 1; i++)
+      acLongKey[i] = 'a';
+   acLongKey[LONG_KEY_SIZE - 1] = '\0';
+
+   oSymTable = SymTable_newArena();
+   ASSURE(oSymTable != NULL);
+
+   /* Fill, empty, and refill the table so that removed bindings are
+      reused by later puts. */
+   for (iRound = 0; iRound < 2; iRound++)
+   {
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+         ASSURE(iSuccessful);
+      }
+      iSuccessful = SymTable_put(oSymTable, acLongKey, acCenterField);
+      ASSURE(iSuccessful);
+
+      uLength = SymTable_getLength(oSymTable);
+      ASSURE(uLength == BINDING_COUNT + 1);
+
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         pcValue = (char*)SymTable_get(oSymTable, acKey);
+         ASSURE(pcValue == acShortstop);
+      }
+      pcValue = (char*)SymTable_get(oSymTable, acLongKey);
+      ASSURE(pcValue == acCenterField);
+
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         pcValue = (char*)SymTable_remove(oSymTable, acKey);
+         ASSURE(pcValue == acShortstop);
+      }
+      pcValue = (char*)SymTable_remove(oSymTable, acLongKey);
+      ASSURE(pcValue == acCenterField);
+
+      uLength = SymTable_getLength(oSymTable);
+      ASSURE(uLength == 0);
+   }
+
+   /* Free a table that still holds bindings. */
+   iSuccessful = SymTable_put(oSymTable, "Jeter", acShortstop);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(pcValue == acShortstop);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The number of blocks and bytes currently allocated by
+   countingAlloc(). */
+
+struct AllocCounts
+{
+   size_t uBlocks;
+   size_t uBytes;
+};
+
+/* A header placed before each block allocated by countingAlloc(), to
+   remember the block's size. The union keeps the block aligned. */
+
+union AllocHeader
+{
+   size_t uSize;
+   long double ldAlign;
+   void *pvAlign;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Allocate uSize bytes with malloc(), and count them in pvAllocExtra,
+   which must be a struct AllocCounts. */
+
+static void *countingAlloc(size_t uSize, void *pvAllocExtra)
+{
+   struct AllocCounts *psCounts = (struct AllocCounts*)pvAllocExtra;
+   union AllocHeader *puHeader;
+
+   assert(psCounts != NULL);
+
+   puHeader = (union AllocHeader*)malloc(sizeof(union AllocHeader) + uSize);
+   if (puHeader == NULL)
+      return NULL;
+   puHeader->uSize = uSize;
+
+   psCounts->uBlocks++;
+   psCounts->uBytes += uSize;
+   return puHeader + 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free pvBlock, which countingAlloc() allocated with size uSize, and
+   uncount it in pvAllocExtra. */
+
+static void countingFree(void *pvBlock, size_t uSize, void *pvAllocExtra)
+{
+   struct AllocCounts *psCounts = (struct AllocCounts*)pvAllocExtra;
+   union AllocHeader *puHeader;
+
+   assert(pvBlock != NULL);
+   assert(psCounts != NULL);
+
+   puHeader = (union AllocHeader*)pvBlock - 1;
+   ASSURE(puHeader->uSize == uSize);
+
+   psCounts->uBlocks--;
+   psCounts->uBytes -= uSize;
+   free(puHeader);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable object created by SymTable_newWithAllocator(), and
+   check that it returns every block it allocates. */
+
+static void testAllocator(void)
+{
+   enum {BINDING_COUNT = 5000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   struct AllocCounts sCounts = {0, 0};
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+   size_t uLength;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_newWithAllocator().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newWithAllocator(countingAlloc, countingFree,
+      &sCounts);
+   ASSURE(oSymTable != NULL);
+   ASSURE(sCounts.uBlocks > 0);
+
+   /* Grow the table through several resizes. */
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == BINDING_COUNT);
+   ASSURE(sCounts.uBytes > BINDING_COUNT * strlen("4999"));
+
+   /* Shrink it again, leaving some bindings for SymTable_free(). */
+   for (i = 0; i < BINDING_COUNT - 10; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+   pcValue = (char*)SymTable_get(oSymTable, "4999");
+   ASSURE(pcValue == acShortstop);
+
+   SymTable_free(oSymTable);
+   ASSURE(sCounts.uBlocks == 0);
+   ASSURE(sCounts.uBytes == 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that the chain-length histogram in psStats accounts for every
+   bucket, and for at least as many bindings as it can see. */
+
+static void checkStats(const SymTable_Stats *psStats)
+{
+   size_t uBuckets = 0;
+   size_t uBindings = 0;
+   size_t i;
+
+   assert(psStats != NULL);
+
+   for (i = 0; i < SYMTABLE_HISTOGRAM_SIZE; i++)
+   {
+      uBuckets += psStats->auChainLengths[i];
+      uBindings += i * psStats->auChainLengths[i];
+   }
+   ASSURE(uBuckets == psStats->uBucketCount);
+   ASSURE(uBindings <= psStats->uLength);
+   ASSURE(psStats->auChainLengths[0] == psStats->uEmptyBuckets);
+   ASSURE(psStats->uEmptyBuckets <= psStats->uBucketCount);
+   ASSURE(psStats->uKeyCompares <= psStats->uProbes);
+   if (psStats->uLength == 0)
+      ASSURE(psStats->uMaxChainLength == 0);
+   else
+   {
+      ASSURE(psStats->uMaxChainLength > 0);
+      ASSURE(psStats->dMeanChainLength >= 1.0);
+      ASSURE(psStats->dMeanChainLength
+         <= (double)psStats->uMaxChainLength);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_getStats(). */
+
+static void testStats(void)
+{
+   enum {BINDING_COUNT = 5000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   SymTable_Stats sStats;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+   size_t uProbes;
+   size_t uKeyCompares;
+   static unsigned long aulCounts[SYMTABLE_LATENCY_BUCKETS];
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_getStats().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   iSuccessful = SymTable_getStats(oSymTable, &sStats);
+   ASSURE(iSuccessful);
+   ASSURE(sStats.uLength == 0);
+   ASSURE(sStats.uBucketCount > 0);
+   ASSURE(sStats.uEmptyBuckets == sStats.uBucketCount);
+   ASSURE(sStats.uExpansions == 0);
+   ASSURE(sStats.uShrinks == 0);
+   ASSURE(sStats.uProbes == 0);
+   checkStats(&sStats);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+
+   iSuccessful = SymTable_getStats(oSymTable, &sStats);
+   ASSURE(iSuccessful);
+   ASSURE(sStats.uLength == BINDING_COUNT);
+   checkStats(&sStats);
+
+   /* A successful search compares at least the key it finds, in a
+      table built with -DSYMTABLE_TRACE; other tables count nothing. */
+   uProbes = sStats.uProbes;
+   uKeyCompares = sStats.uKeyCompares;
+   pcValue = (char*)SymTable_get(oSymTable, "2500");
+   ASSURE(pcValue == acShortstop);
+   iSuccessful = SymTable_getStats(oSymTable, &sStats);
+   ASSURE(iSuccessful);
+   if (SymTable_getLatencyHistogram(oSymTable, SYMTABLE_OP_GET, aulCounts))
+   {
+      ASSURE(sStats.uProbes > uProbes);
+      ASSURE(sStats.uKeyCompares > uKeyCompares);
+   }
+   else
+   {
+      ASSURE(sStats.uProbes == 0);
+      ASSURE(sStats.uKeyCompares == 0);
+   }
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+
+   iSuccessful = SymTable_getStats(oSymTable, &sStats);
+   ASSURE(iSuccessful);
+   ASSURE(sStats.uLength == 0);
+   ASSURE(sStats.uEmptyBuckets == sStats.uBucketCount);
+   ASSURE(sStats.uShrinks <= sStats.uExpansions);
+   checkStats(&sStats);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A hash function that gives every key the same hash, and counts its
+   calls in *pvHashExtra, a size_t. */
+
+static size_t constantHash(const char *pcKey, size_t uKeyLength,
+                           const void *pvHashExtra)
+{
+   assert(strlen(pcKey) == uKeyLength);
+   (*(size_t*)pvHashExtra)++;
+   return 42;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_newWithHash() and the built-in hash functions. */
+
+static void testHash(void)
+{
+   enum {BINDING_COUNT = 500, MAX_KEY_LENGTH = 100};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+   size_t uHashCalls = 0;
+   unsigned long long ullSeed = 217;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_newWithHash().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* The assignment hash puts "250" and "469" in the same one of 509
+      buckets, as testCollisions() assumes. */
+   ASSURE(SymTable_hash65599("250", 3, NULL) % 509 ==
+          SymTable_hash65599("469", 3, NULL) % 509);
+
+   /* Equal keys have equal hashes, whatever follows them in memory,
+      and the seed changes the hash. */
+   ASSURE(SymTable_hashWyhash("org.example.Shortstop", 21, NULL) ==
+          SymTable_hashWyhash("org.example.Shortstop!", 21, NULL));
+   ASSURE(SymTable_hashWyhash("org.example.Shortstop", 21, NULL) !=
+          SymTable_hashWyhash("org.example.Shortstop", 21, &ullSeed));
+   ASSURE(SymTable_hashWyhash("", 0, NULL) !=
+          SymTable_hashWyhash("a", 1, NULL));
+
+   /* Every key colliding must still work, if slowly. */
+   oSymTable = SymTable_newWithHash(constantHash, &uHashCalls);
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT);
+
+   pcValue = (char*)SymTable_get(oSymTable, "250");
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_remove(oSymTable, "469");
+   ASSURE(pcValue == acShortstop);
+   ASSURE(! SymTable_contains(oSymTable, "469"));
+
+   SymTable_free(oSymTable);
+
+   /* Long dotted keys with the wyhash hash and a seed. */
+   oSymTable = SymTable_newWithHash(SymTable_hashWyhash, &ullSeed);
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "org.example.compiler.backend.codegen.x86_64."
+              "InstructionSelector.pattern%d.operand", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "org.example.compiler.backend.codegen.x86_64."
+              "InstructionSelector.pattern%d.operand", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(! iSuccessful);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_newSeeded() with keys that all have the same hash under
+   the assignment hash: every key is a sequence of two blocks whose
+   hashes are equal. A seeded hash table spreads them out. */
+
+static void testSeeded(void)
+{
+   enum {BLOCK_COUNT = 6, KEY_COUNT = 1 << BLOCK_COUNT,
+         BLOCK_LENGTH = 16};
+
+   static const char acBlockA[] = "baffaaeaajcaaafc";
+   static const char acBlockB[] = "acaagbacbaabccaa";
+
+   SymTable_T oSymTable;
+   SymTable_T oSeededTable;
+   SymTable_Stats sStats;
+   char acKey[BLOCK_COUNT * BLOCK_LENGTH + 1];
+   char acShortstop[] = "Shortstop";
+   char *pcValue;
+   int i;
+   int iBlock;
+   int iSuccessful;
+   unsigned long long aullSeed[2] = {1, 2};
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_newSeeded().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* The keyed hash depends on the key. */
+   ASSURE(SymTable_hashSiphash13(acBlockA, BLOCK_LENGTH, aullSeed) ==
+          SymTable_hashSiphash13(acBlockA, BLOCK_LENGTH, aullSeed));
+   ASSURE(SymTable_hashSiphash13(acBlockA, BLOCK_LENGTH, aullSeed) !=
+          SymTable_hashSiphash13(acBlockB, BLOCK_LENGTH, aullSeed));
+   aullSeed[1] = 3;
+   ASSURE(SymTable_hashSiphash13(acBlockA, BLOCK_LENGTH, aullSeed) !=
+          SymTable_hashSiphash13(acBlockB, BLOCK_LENGTH, aullSeed));
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   oSeededTable = SymTable_newSeeded();
+   ASSURE(oSeededTable != NULL);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      for (iBlock = 0; iBlock < BLOCK_COUNT; iBlock++)
+         memcpy(acKey + iBlock * BLOCK_LENGTH,
+                ((i >> iBlock) & 1) ? acBlockB : acBlockA, BLOCK_LENGTH);
+      acKey[BLOCK_COUNT * BLOCK_LENGTH] = '\0';
+
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+      iSuccessful = SymTable_put(oSeededTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+
+   /* The blocks collide without a seed ... */
+   iSuccessful = SymTable_getStats(oSymTable, &sStats);
+   ASSURE(iSuccessful);
+   ASSURE(sStats.uMaxChainLength == KEY_COUNT);
+
+   /* ... but not with one. */
+   iSuccessful = SymTable_getStats(oSeededTable, &sStats);
+   ASSURE(iSuccessful);
+   ASSURE(sStats.uLength == KEY_COUNT);
+   ASSURE(sStats.uBucketCount == 1 || sStats.uMaxChainLength < 16);
+
+   pcValue = (char*)SymTable_get(oSeededTable, acKey);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_remove(oSeededTable, acKey);
+   ASSURE(pcValue == acShortstop);
+   ASSURE(! SymTable_contains(oSeededTable, acKey));
+
+   SymTable_free(oSymTable);
+   SymTable_free(oSeededTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_upsert(), SymTable_getOrPut() and SymTable_getFound(),
+   including that each hashes its key once, whether the key is bound or
+   not and whether or not it makes the table grow. */
+
+static void testUpsert(void)
+{
+   enum {BINDING_COUNT = 2000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char acCatcher[] = "Catcher";
+   char *pcValue;
+   void *pvOldValue;
+   int i;
+   int iResult;
+   int iFound;
+   size_t uHashCalls = 0;
+   size_t uBefore;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_upsert() and SymTable_getOrPut().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Upsert adds, then replaces and reports the old value. */
+   iResult = SymTable_upsert(oSymTable, "Ruth", acShortstop, NULL);
+   ASSURE(iResult == 1);
+   pvOldValue = NULL;
+   iResult = SymTable_upsert(oSymTable, "Ruth", acCatcher, &pvOldValue);
+   ASSURE(iResult == 0);
+   ASSURE(pvOldValue == acShortstop);
+   ASSURE(SymTable_get(oSymTable, "Ruth") == acCatcher);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+
+   /* GetOrPut returns the bound value and leaves it alone... */
+   iResult = -2;
+   pcValue = (char*)SymTable_getOrPut(oSymTable, "Ruth", acShortstop,
+                                      &iResult);
+   ASSURE(pcValue == acCatcher);
+   ASSURE(iResult == 0);
+
+   /* ... or binds the given one. */
+   pcValue = (char*)SymTable_getOrPut(oSymTable, "Gehrig", acShortstop,
+                                      &iResult);
+   ASSURE(pcValue == acShortstop);
+   ASSURE(iResult == 1);
+   pcValue = (char*)SymTable_getOrPut(oSymTable, "Gehrig", acCatcher, NULL);
+   ASSURE(pcValue == acShortstop);
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+
+   /* GetFound tells a NULL value apart from a missing key. */
+   iResult = SymTable_upsert(oSymTable, "Mantle", NULL, NULL);
+   ASSURE(iResult == 1);
+   iFound = 0;
+   pcValue = (char*)SymTable_getFound(oSymTable, "Mantle", &iFound);
+   ASSURE(pcValue == NULL);
+   ASSURE(iFound);
+   pcValue = (char*)SymTable_getFound(oSymTable, "Maris", &iFound);
+   ASSURE(pcValue == NULL);
+   ASSURE(! iFound);
+   pcValue = (char*)SymTable_getFound(oSymTable, "Gehrig", &iFound);
+   ASSURE(pcValue == acShortstop);
+   ASSURE(iFound);
+
+   SymTable_free(oSymTable);
+
+   /* One hash per call, through every resize. A table that does not
+      hash keys (symtablelist.c) makes no calls at all. */
+   oSymTable = SymTable_newWithHash(constantHash, &uHashCalls);
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      uBefore = uHashCalls;
+      if (i % 2 == 0)
+         iResult = SymTable_upsert(oSymTable, acKey, acShortstop, NULL);
+      else
+         SymTable_getOrPut(oSymTable, acKey, acShortstop, &iResult);
+      ASSURE(iResult == 1);
+      ASSURE(uHashCalls - uBefore <= 1);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      uBefore = uHashCalls;
+      iResult = SymTable_upsert(oSymTable, acKey, acCatcher, &pvOldValue);
+      ASSURE(iResult == 0);
+      ASSURE(pvOldValue == acShortstop);
+      pcValue = (char*)SymTable_getFound(oSymTable, acKey, &iFound);
+      ASSURE(iFound);
+      ASSURE(pcValue == acCatcher);
+      ASSURE(uHashCalls - uBefore <= 2);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_entry() by counting the occurrences of keys, reading
+   and updating each count in place with one search per key. */
+
+static void testEntry(void)
+{
+   enum {KEY_COUNT = 300, OCCURRENCES = 7, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   int aiCounts[KEY_COUNT];
+   void **ppvValue;
+   int i;
+   int iCreated;
+   int iNextCount = 0;
+   size_t uHashCalls = 0;
+   size_t uBefore;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_entry().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newWithHash(constantHash, &uHashCalls);
+   ASSURE(oSymTable != NULL);
+
+   /* A new binding starts out NULL, and an existing one is found. */
+   ppvValue = SymTable_entry(oSymTable, "Ruth", &iCreated);
+   ASSURE(ppvValue != NULL);
+   ASSURE(iCreated);
+   ASSURE(*ppvValue == NULL);
+   *ppvValue = acShortstop;
+   ASSURE(SymTable_get(oSymTable, "Ruth") == acShortstop);
+   ppvValue = SymTable_entry(oSymTable, "Ruth", NULL);
+   ASSURE(ppvValue != NULL);
+   ASSURE(*ppvValue == acShortstop);
+   ASSURE(SymTable_remove(oSymTable, "Ruth") == acShortstop);
+
+   /* Count each key OCCURRENCES times, visiting every key before
+      revisiting any. */
+   for (i = 0; i < KEY_COUNT * OCCURRENCES; i++)
+   {
+      sprintf(acKey, "%d", i % KEY_COUNT);
+      uBefore = uHashCalls;
+      ppvValue = SymTable_entry(oSymTable, acKey, &iCreated);
+      ASSURE(ppvValue != NULL);
+      ASSURE(uHashCalls - uBefore <= 1);
+      ASSURE(iCreated == (i < KEY_COUNT));
+      if (iCreated)
+      {
+         aiCounts[iNextCount] = 0;
+         *ppvValue = &aiCounts[iNextCount];
+         iNextCount++;
+      }
+      (*(int*)*ppvValue)++;
+   }
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(*(int*)SymTable_get(oSymTable, acKey) == OCCURRENCES);
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_getMany() with a batch of keys that spans several of
+   its internal batches and mixes hits, misses, repeated keys and a
+   NULL value. */
+
+static void testGetMany(void)
+{
+   enum {BINDING_COUNT = 1000, KEY_COUNT = 2 * BINDING_COUNT + 3,
+         MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   static char aacKeys[KEY_COUNT][MAX_KEY_LENGTH];
+   const char *apcKeys[KEY_COUNT];
+   void *apvValues[KEY_COUNT];
+   char acShortstop[] = "Shortstop";
+   size_t uFound;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_getMany().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Bind the even numbers below 2 * BINDING_COUNT to their keys, and
+      "" to NULL. */
+   for (i = 0; i < 2 * BINDING_COUNT; i++)
+   {
+      sprintf(aacKeys[i], "%d", i);
+      apcKeys[i] = aacKeys[i];
+      if (i % 2 == 0)
+      {
+         iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+         ASSURE(iSuccessful);
+      }
+   }
+   iSuccessful = SymTable_put(oSymTable, "", NULL);
+   ASSURE(iSuccessful);
+   apcKeys[2 * BINDING_COUNT] = "";
+   apcKeys[2 * BINDING_COUNT + 1] = "0";
+   apcKeys[2 * BINDING_COUNT + 2] = "Shortstop";
+
+   for (i = 0; i < KEY_COUNT; i++)
+      apvValues[i] = acShortstop;
+   uFound = SymTable_getMany(oSymTable, apcKeys, KEY_COUNT, apvValues);
+   ASSURE(uFound == BINDING_COUNT + 2);
+
+   for (i = 0; i < KEY_COUNT; i++)
+      ASSURE(apvValues[i] == SymTable_get(oSymTable, apcKeys[i]));
+   ASSURE(apvValues[0] == aacKeys[0]);
+   ASSURE(apvValues[1] == NULL);
+
+   /* An empty batch does nothing. */
+   apvValues[0] = acShortstop;
+   uFound = SymTable_getMany(oSymTable, apcKeys, 0, apvValues);
+   ASSURE(uFound == 0);
+   ASSURE(apvValues[0] == acShortstop);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_getManyInterleaved() at several widths, on a table with
+   short chains and on one where every key shares one long chain, so
+   that searches finish out of order. */
+
+static void testGetManyInterleaved(void)
+{
+   enum {BINDING_COUNT = 600, KEY_COUNT = 2 * BINDING_COUNT,
+         MAX_KEY_LENGTH = 10};
+   static const size_t auWidths[] = {1, 3, 16, SYMTABLE_MAX_INTERLEAVE};
+
+   SymTable_T aoSymTables[2];
+   static char aacKeys[KEY_COUNT][MAX_KEY_LENGTH];
+   const char *apcKeys[KEY_COUNT];
+   void *apvValues[KEY_COUNT];
+   size_t uHashCalls = 0;
+   size_t uFound;
+   size_t uWidth;
+   size_t u;
+   int iTable;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_getManyInterleaved().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   aoSymTables[0] = SymTable_new();
+   ASSURE(aoSymTables[0] != NULL);
+   aoSymTables[1] = SymTable_newWithHash(constantHash, &uHashCalls);
+   ASSURE(aoSymTables[1] != NULL);
+
+   /* Bind every third key, so hits and misses alternate unevenly. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(aacKeys[i], "%d", (i * 7919) % KEY_COUNT);
+      apcKeys[i] = aacKeys[i];
+      if (i % 3 == 0)
+      {
+         for (iTable = 0; iTable < 2; iTable++)
+         {
+            iSuccessful = SymTable_put(aoSymTables[iTable], aacKeys[i],
+                                       aacKeys[i]);
+            ASSURE(iSuccessful);
+         }
+      }
+   }
+
+   for (iTable = 0; iTable < 2; iTable++)
+   {
+      for (u = 0; u < sizeof(auWidths) / sizeof(auWidths[0]); u++)
+      {
+         uWidth = auWidths[u];
+         uFound = SymTable_getManyInterleaved(aoSymTables[iTable], apcKeys,
+                                              KEY_COUNT, apvValues, uWidth);
+         ASSURE(uFound == KEY_COUNT / 3);
+         for (i = 0; i < KEY_COUNT; i++)
+            ASSURE(apvValues[i] ==
+                   (i % 3 == 0 ? (void*)aacKeys[i] : NULL));
+
+         /* Fewer keys than the width */
+         uFound = SymTable_getManyInterleaved(aoSymTables[iTable], apcKeys,
+                                              2, apvValues, uWidth);
+         ASSURE(uFound == 1);
+         ASSURE(apvValues[0] == aacKeys[0]);
+         ASSURE(apvValues[1] == NULL);
+      }
+   }
+
+   SymTable_free(aoSymTables[0]);
+   SymTable_free(aoSymTables[1]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_putMany(), including that it grows the table at most
+   once however many keys it adds, and its flags for keys that are
+   already bound. */
+
+static void testPutMany(void)
+{
+   enum {KEY_COUNT = 5000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   static char aacKeys[KEY_COUNT][MAX_KEY_LENGTH];
+   const char *apcKeys[KEY_COUNT];
+   const void *apvValues[KEY_COUNT];
+   int aiAdded[KEY_COUNT];
+   char acShortstop[] = "Shortstop";
+   SymTable_Stats sStats;
+   size_t uAdded;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_putMany().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   iSuccessful = SymTable_put(oSymTable, "7", acShortstop);
+   ASSURE(iSuccessful);
+
+   /* Key i is i / 2 for the first half and i after that, so the first
+      half binds each key twice, and "7" is already bound. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(aacKeys[i], "%d", i < KEY_COUNT / 2 ? i / 2 : i);
+      apcKeys[i] = aacKeys[i];
+      apvValues[i] = aacKeys[i];
+   }
+
+   uAdded = SymTable_putMany(oSymTable, apcKeys, apvValues, KEY_COUNT,
+                             aiAdded);
+   ASSURE(uAdded == KEY_COUNT / 4 + KEY_COUNT / 2 - 1);
+   ASSURE(SymTable_getLength(oSymTable) == uAdded + 1);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      if (i < KEY_COUNT / 2)
+         ASSURE(aiAdded[i] == (i % 2 == 0 && i / 2 != 7));
+      else
+         ASSURE(aiAdded[i]);
+      if (aiAdded[i])
+         ASSURE(SymTable_get(oSymTable, apcKeys[i]) == aacKeys[i]);
+   }
+   ASSURE(SymTable_get(oSymTable, "7") == acShortstop);
+
+   iSuccessful = SymTable_getStats(oSymTable, &sStats);
+   ASSURE(iSuccessful);
+   ASSURE(sStats.uExpansions <= 1);
+
+   /* Without flags, and with nothing left to add */
+   uAdded = SymTable_putMany(oSymTable, apcKeys, apvValues, KEY_COUNT,
+                             NULL);
+   ASSURE(uAdded == 0);
+   uAdded = SymTable_putMany(oSymTable, apcKeys, apvValues, 0, aiAdded);
+   ASSURE(uAdded == 0);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Iterate over oSymTable, whose keys are "0" to "iBindingCount - 1",
+   each bound to its entry of aiSeen, and ASSURE that every binding is
+   visited exactly once. */
+
+static void checkIteration(SymTable_T oSymTable, int aiSeen[],
+                           int iBindingCount)
+{
+   SymTableIter_T oIter;
+   const char *pcKey;
+   void *pvValue;
+   int i;
+
+   for (i = 0; i < iBindingCount; i++)
+      aiSeen[i] = 0;
+
+   oIter = SymTable_iterBegin(oSymTable);
+   ASSURE(oIter != NULL);
+   while (SymTable_iterNext(oIter, &pcKey, &pvValue))
+   {
+      i = atoi(pcKey);
+      ASSURE(i >= 0 && i < iBindingCount);
+      ASSURE(pvValue == &aiSeen[i]);
+      aiSeen[i]++;
+   }
+   /* An exhausted iterator stays exhausted. */
+   ASSURE(! SymTable_iterNext(oIter, NULL, NULL));
+   SymTable_iterEnd(oIter);
+
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(aiSeen[i] == 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_iterBegin(), SymTable_iterNext() and
+   SymTable_iterEnd(), at every size on the way past the first
+   expansion of a hash table, so that an incremental build is also
+   tested while a resize is in progress. */
+
+static void testIterator(void)
+{
+   enum {BINDING_COUNT = 700, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   SymTableIter_T oIter;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   static int aiSeen[BINDING_COUNT];
+   const char *pcKey;
+   void *pvValue;
+   int i;
+   int iSuccessful;
+   int iVisited;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_iterBegin() and SymTable_iterNext().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   checkIteration(oSymTable, aiSeen, 0);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiSeen[i]);
+      ASSURE(iSuccessful);
+      checkIteration(oSymTable, aiSeen, i + 1);
+   }
+
+   /* Values may be replaced while iterating, and an iterator may be
+      ended early. */
+   oIter = SymTable_iterBegin(oSymTable);
+   ASSURE(oIter != NULL);
+   for (iVisited = 0; iVisited < BINDING_COUNT / 2; iVisited++)
+   {
+      iSuccessful = SymTable_iterNext(oIter, &pcKey, &pvValue);
+      ASSURE(iSuccessful);
+      ASSURE(SymTable_replace(oSymTable, pcKey, acShortstop) == pvValue);
+   }
+   SymTable_iterEnd(oIter);
+
+   iVisited = 0;
+   oIter = SymTable_iterBegin(oSymTable);
+   ASSURE(oIter != NULL);
+   while (SymTable_iterNext(oIter, NULL, &pvValue))
+      iVisited += pvValue == acShortstop;
+   SymTable_iterEnd(oIter);
+   ASSURE(iVisited == BINDING_COUNT / 2);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Increment the int that pvValue points to. Each binding has its own,
+   so concurrent calls for different bindings do not race. pvExtra
+   points to a check value. */
+
+static void countVisit(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(*(int*)pvExtra == 217);
+   (*(int*)pvValue)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look pcKey up in the table that pvExtra is, ASSURE that it is bound
+   to pvValue, and increment the int that pvValue points to, as
+   countVisit does. */
+
+static void lookUpVisit(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   SymTable_T oSymTable = pvExtra;
+
+   ASSURE(SymTable_get(oSymTable, pcKey) == pvValue);
+   ASSURE(SymTable_contains(oSymTable, pcKey));
+   (*(int*)pvValue)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_mapParallel() with several thread counts, including
+   more threads than bindings, at sizes on both sides of the first
+   expansion of a hash table, and with a pfApply that looks up the
+   table it is applied to. A table built with -DSYMTABLE_TRACE records
+   every lookup in itself, so that case is skipped there. */
+
+static void testMapParallel(void)
+{
+   enum {BINDING_COUNT = 1000, MAX_KEY_LENGTH = 12};
+   static const size_t auThreads[] = {1, 2, 7, 300};
+   static const int aiSizes[] = {0, 1, 520, BINDING_COUNT};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiSeen[BINDING_COUNT];
+   static unsigned long aulCounts[SYMTABLE_LATENCY_BUCKETS];
+   int iCheck = 217;
+   int iBindingCount = 0;
+   int iTraced;
+   size_t uThreads;
+   size_t u;
+   int iSize;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_mapParallel().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iTraced = SymTable_getLatencyHistogram(oSymTable, SYMTABLE_OP_GET,
+                                          aulCounts);
+
+   for (iSize = 0; iSize < (int)(sizeof(aiSizes) / sizeof(aiSizes[0]));
+        iSize++)
+   {
+      for (; iBindingCount < aiSizes[iSize]; iBindingCount++)
+      {
+         sprintf(acKey, "%d", iBindingCount);
+         iSuccessful = SymTable_put(oSymTable, acKey,
+                                    &aiSeen[iBindingCount]);
+         ASSURE(iSuccessful);
+      }
+
+      for (u = 0; u < sizeof(auThreads) / sizeof(auThreads[0]); u++)
+      {
+         uThreads = auThreads[u];
+         for (i = 0; i < iBindingCount; i++)
+            aiSeen[i] = 0;
+         SymTable_mapParallel(oSymTable, countVisit, &iCheck, uThreads);
+         for (i = 0; i < iBindingCount; i++)
+            ASSURE(aiSeen[i] == 1);
+
+         if (iTraced)
+            continue;
+         SymTable_mapParallel(oSymTable, lookUpVisit, oSymTable, uThreads);
+         for (i = 0; i < iBindingCount; i++)
+            ASSURE(aiSeen[i] == 2);
+      }
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the total number of calls counted by the latency histogram of
+   operation eOp on oSymTable, or -1 if oSymTable does not record
+   latencies. */
+
+static long countLatencies(SymTable_T oSymTable, enum SymTable_Op eOp)
+{
+   unsigned long aulCounts[SYMTABLE_LATENCY_BUCKETS];
+   long lTotal = 0;
+   size_t u;
+
+   if (! SymTable_getLatencyHistogram(oSymTable, eOp, aulCounts))
+      return -1;
+
+   for (u = 0; u < SYMTABLE_LATENCY_BUCKETS; u++)
+      lTotal += (long)aulCounts[u];
+   return lTotal;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_getLatencyHistogram() and
+   SymTable_latencyBucketStart(). Tables built without -DSYMTABLE_TRACE
+   record no latencies, so only the bucket bounds are tested then. */
+
+static void testLatency(void)
+{
+   enum {BINDING_COUNT = 5000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+   size_t u;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_getLatencyHistogram().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Bucket bounds start at 0 and increase. */
+   ASSURE(SymTable_latencyBucketStart(0) == 0);
+   for (u = 1; u < SYMTABLE_LATENCY_BUCKETS; u++)
+      ASSURE(SymTable_latencyBucketStart(u) >
+             SymTable_latencyBucketStart(u - 1));
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   if (countLatencies(oSymTable, SYMTABLE_OP_PUT) == -1)
+   {
+      SymTable_free(oSymTable);
+      return;
+   }
+
+   ASSURE(countLatencies(oSymTable, SYMTABLE_OP_PUT) == 0);
+
+   /* Every put is counted once, as a put or as a resize. */
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+   iSuccessful = SymTable_put(oSymTable, "0", acShortstop);
+   ASSURE(! iSuccessful);
+   ASSURE(countLatencies(oSymTable, SYMTABLE_OP_PUT) +
+          countLatencies(oSymTable, SYMTABLE_OP_RESIZE) ==
+          BINDING_COUNT + 1);
+
+   pcValue = (char*)SymTable_get(oSymTable, "2500");
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_get(oSymTable, "Catcher");
+   ASSURE(pcValue == NULL);
+   ASSURE(countLatencies(oSymTable, SYMTABLE_OP_GET) == 2);
+   ASSURE(countLatencies(oSymTable, SYMTABLE_OP_CONTAINS) == 0);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+   ASSURE(countLatencies(oSymTable, SYMTABLE_OP_PUT) +
+          countLatencies(oSymTable, SYMTABLE_OP_REMOVE) +
+          countLatencies(oSymTable, SYMTABLE_OP_RESIZE) ==
+          2 * BINDING_COUNT + 1);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the ability of a SymTable object to be large, that is, to
-   contain iBindingCount bindings. Write the time consumed to stdout. */
+   contain iBindingCount bindings. If iPresized, create the table with
+   SymTable_newWithCapacity() so that it never needs to resize. Write
+   the time consumed to stdout. */
 
-static void testLargeTable(int iBindingCount)
+static void testLargeTable(int iBindingCount, int iPresized)
 {
    enum {MAX_KEY_LENGTH = 10};
 
@@ -797,7 +2028,10 @@ static void testLargeTable(int iBindingCount)
    size_t uLength2;
 
    printf("------------------------------------------------------\n");
-   printf("Testing a potentially large SymTable object.\n");
+   if (iPresized)
+      printf("Testing a potentially large presized SymTable object.\n");
+   else
+      printf("Testing a potentially large SymTable object.\n");
    printf("No output except CPU time consumed should appear here:\n");
    fflush(stdout);
 
@@ -813,7 +2047,10 @@ static void testLargeTable(int iBindingCount)
    ASSURE(iSuccessful);
 
    /* Create oSymTable, the primary SymTable object. */
-   oSymTable = SymTable_new();
+   if (iPresized)
+      oSymTable = SymTable_newWithCapacity((size_t)iBindingCount);
+   else
+      oSymTable = SymTable_new();
    ASSURE(oSymTable != NULL);
 
    /* Put iBindingCount new bindings into oSymTable.  Each binding's
@@ -912,6 +2149,11 @@ static void testLargeTable(int iBindingCount)
    iFinalClock = clock();
    printf("CPU time (%d bindings):  %f seconds\n", iBindingCount,
       ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+   /* Per-binding cost should stay flat as iBindingCount grows. */
+   if (iBindingCount > 0)
+      printf("CPU time per binding:  %f microseconds\n",
+         ((double)(iFinalClock - iInitialClock)) * 1000000.0
+         / CLOCKS_PER_SEC / iBindingCount);
    fflush(stdout);
 }
 
@@ -960,7 +2202,22 @@ int main(int argc, char *argv[])
    testLongKey();
    testTableOfTables();
    testCollisions();
-   testLargeTable(iBindingCount);
+   testReserve();
+   testArena();
+   testAllocator();
+   testStats();
+   testHash();
+   testSeeded();
+   testUpsert();
+   testEntry();
+   testGetMany();
+   testGetManyInterleaved();
+   testPutMany();
+   testIterator();
+   testMapParallel();
+   testLatency();
+   testLargeTable(iBindingCount, 0);
+   testLargeTable(iBindingCount, 1);
 
    printf("------------------------------------------------------\n");
    printf("End of %s.\n", argv[0]);